@@ -33,6 +33,7 @@ bool Process(int argc, char** argv, RunSettings& settings) {
     std::string target_time;
     std::string additional_params;
     std::string devices;
+    uint64_t random_seed = 0;
 
     boost::program_options::options_description desc("Allowed options");
     // clang-format off
@@ -59,6 +60,8 @@ bool Process(int argc, char** argv, RunSettings& settings) {
         ("cpu,c", "run fixtures on OpenCL CPU devices")
         ("gpu,g", "run fixtures on OpenCL GPU devices")
         ("other-devices", "run fixtures on OpenCL accelerators and other devices")
+        ("random-seed", po::value<uint64_t>(&random_seed),
+            "seed of random input data (by default a random one is used), it is written to the output file, so a run can be replayed")
         ;
     // clang-format on
 
@@ -98,6 +101,9 @@ bool Process(int argc, char** argv, RunSettings& settings) {
     }
     settings.min_iterations = min_iterations;
     settings.max_iterations = max_iterations;
+    if (vm.count("random-seed") > 0) {
+        settings.random_seed = random_seed;
+    }
     try {
         size_t index = 0;
         double val = std::stod(target_time, &index);
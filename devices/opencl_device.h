@@ -4,20 +4,34 @@
 
 #include "devices/device_interface.h"
 
+/*
+Context and command queue are created on the first use, creation may be slow (e.g. CPU runtimes
+start thread pools), so listing devices and runs that skip a device don't pay for it.
+Device information (name, extensions, type through device()) doesn't need a context.
+*/
 class OpenClDevice : public DeviceInterface {
 public:
     OpenClDevice(
         const boost::compute::device& compute_device, std::weak_ptr<PlatformInterface> platform)
-        : device_(compute_device),
-          context_(compute_device),
-          queue_(context_, compute_device, boost::compute::command_queue::enable_profiling),
-          platform_(platform) {}
+        : device_(compute_device), platform_(platform) {}
 
     virtual std::string Name() override { return device_.name(); }
 
-    boost::compute::context& GetContext() { return context_; }
+    boost::compute::context& GetContext() {
+        if (context_.get() == nullptr) {
+            context_ = boost::compute::context(device_);
+        }
+        return context_;
+    }
 
-    boost::compute::command_queue& GetQueue() { return queue_; }
+    // In-order queue with profiling enabled
+    boost::compute::command_queue& GetQueue() {
+        if (queue_.get() == nullptr) {
+            queue_ = boost::compute::command_queue(
+                GetContext(), device_, boost::compute::command_queue::enable_profiling);
+        }
+        return queue_;
+    }
 
     boost::compute::device& device() { return device_; }
 
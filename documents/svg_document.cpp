@@ -1,37 +1,261 @@
 #include "svg_document.h"
 
-#include <boost/format.hpp>
 #include <boost/log/trivial.hpp>
-#include <boost/property_tree/xml_parser.hpp>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
 
-SvgDocument::SvgDocument() {
-    tree_.put("svg.<xmlattr>.xmlns", "http://www.w3.org/2000/svg");
-    tree_.put("svg.<xmlattr>.xmlns:xlink", "http://www.w3.org/1999/xlink");
-    tree_.put("svg.<xmlattr>.stroke", "black");
+namespace {
+template <typename T>
+T ParseValue(const char* str);
+
+template <>
+float ParseValue<float>(const char* str) {
+    return std::strtof(str, nullptr);
+}
+
+template <>
+double ParseValue<double>(const char* str) {
+    return std::strtod(str, nullptr);
+}
+
+double PowerOf10(int exponent) {
+    // Powers up to 10^22 are exactly representable by double
+    static const double kPowers[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                     1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                     1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    if (exponent >= 0 && exponent <= 22) {
+        return kPowers[exponent];
+    }
+    return std::pow(10.0, exponent);
+}
+
+/*
+Writes given significant digits of a number (with trailing zeros removed) to str, decimal
+exponent is an exponent of the first digit. Returns length of the string.
+*/
+int WriteDigits(char* str, bool negative, const char* digits, int digit_count, int exponent) {
+    char* out = str;
+    if (negative) {
+        *out++ = '-';
+    }
+    if (exponent < -5 || exponent >= 17) {
+        // Scientific notation: d.ddde+xx
+        *out++ = digits[0];
+        if (digit_count > 1) {
+            *out++ = '.';
+            for (int i = 1; i < digit_count; ++i) {
+                *out++ = digits[i];
+            }
+        }
+        out += std::sprintf(out, "e%d", exponent);
+    } else if (exponent < 0) {
+        *out++ = '0';
+        *out++ = '.';
+        for (int i = -1; i > exponent; --i) {
+            *out++ = '0';
+        }
+        for (int i = 0; i < digit_count; ++i) {
+            *out++ = digits[i];
+        }
+    } else {
+        for (int i = 0; i <= exponent || i < digit_count; ++i) {
+            if (i == exponent + 1) {
+                *out++ = '.';
+            }
+            *out++ = i < digit_count ? digits[i] : '0';
+        }
+    }
+    *out = '\0';
+    return static_cast<int>(out - str);
+}
+
+/*
+Formats a number with given count of significant digits. Digits are calculated with
+double precision arithmetic, so result may be inexact for large precisions,
+caller must verify it.
+*/
+int FormatWithPrecision(char* str, double v, int precision) {
+    const bool negative = v < 0;
+    const double abs_v = std::fabs(v);
+    int exponent = static_cast<int>(std::floor(std::log10(abs_v)));
+    if (abs_v < PowerOf10(exponent)) {
+        // log10 was rounded up, e.g. for the largest double below 1000
+        --exponent;
+    }
+    const int scale = precision - 1 - exponent;
+    double scaled = scale >= 0 ? abs_v * PowerOf10(scale) : abs_v / PowerOf10(-scale);
+    uint64_t mantissa = static_cast<uint64_t>(std::llround(scaled));
+    if (mantissa >= static_cast<uint64_t>(PowerOf10(precision))) {
+        // Rounding produced an extra digit, e.g. 9.99 -> 10.0
+        mantissa /= 10;
+        ++exponent;
+    }
+    char digits[24];
+    int digit_count = precision;
+    for (int i = precision - 1; i >= 0; --i) {
+        digits[i] = static_cast<char>('0' + mantissa % 10);
+        mantissa /= 10;
+    }
+    while (digit_count > 1 && digits[digit_count - 1] == '0') {
+        --digit_count;
+    }
+    return WriteDigits(str, negative, digits, digit_count, exponent);
 }
+}  // namespace
 
-void SvgDocument::SetSize(long double width, long double height) {
-    tree_.put("svg.<xmlattr>.width", width);
-    tree_.put("svg.<xmlattr>.height", height);
+SvgDocument::SvgDocument(
+    const std::string& filename, double width, double height, bool use_path_data)
+    : filename_(filename), use_path_data_(use_path_data) {
+    buffer_.reserve(buffer_size_);
+    stream_.open(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!stream_.is_open()) {
+        BOOST_LOG_TRIVIAL(error) << "Cannot create SVG document " << filename;
+        throw std::runtime_error("Cannot create SVG document " + filename);
+    }
+    Append("<?xml version=\"1.0\" encoding=\"utf-8\"?>\n");
+    Append("<svg xmlns=\"http://www.w3.org/2000/svg\" "
+           "xmlns:xlink=\"http://www.w3.org/1999/xlink\" stroke=\"black\" fill=\"none\" width=\"");
+    AppendValue(width);
+    Append("\" height=\"");
+    AppendValue(height);
+    Append("\">\n");
 }
 
-void SvgDocument::AddLine(long double x1, long double y1, long double x2, long double y2) {
-    boost::property_tree::ptree node;
-    node.put("<xmlattr>.x1", FormatValue(x1));
-    node.put("<xmlattr>.y1", FormatValue(y1));
-    node.put("<xmlattr>.x2", FormatValue(x2));
-    node.put("<xmlattr>.y2", FormatValue(y2));
-    tree_.add_child("svg.line", node);
+void SvgDocument::AddLine(float x1, float y1, float x2, float y2) {
+    AddLineImpl(x1, y1, x2, y2);
 }
 
-void SvgDocument::BuildAndWriteToDisk(const std::string& filename) {
+void SvgDocument::AddLine(double x1, double y1, double x2, double y2) {
+    AddLineImpl(x1, y1, x2, y2);
+}
+
+template <typename T>
+void SvgDocument::AddLineImpl(T x1, T y1, T x2, T y2) {
+    if (closed_) {
+        throw std::logic_error("Attempt to add a line to closed SVG document " + filename_);
+    }
+    if (!use_path_data_) {
+        Append("<line x1=\"");
+        AppendValue(x1);
+        Append("\" y1=\"");
+        AppendValue(y1);
+        Append("\" x2=\"");
+        AppendValue(x2);
+        Append("\" y2=\"");
+        AppendValue(y2);
+        Append("\"/>\n");
+        return;
+    }
+
+    if (path_open_ && path_points_ >= max_path_points_) {
+        ClosePath();
+    }
+    if (!path_open_) {
+        Append("<path d=\"M ");
+        AppendValue(x1);
+        Append(" ");
+        AppendValue(y1);
+        path_open_ = true;
+        path_points_ = 1;
+    } else if (last_x_ != x1 || last_y_ != y1) {
+        // Line doesn't continue the polyline, start a new subpath
+        Append(" M ");
+        AppendValue(x1);
+        Append(" ");
+        AppendValue(y1);
+        ++path_points_;
+    }
+    // Coordinate pairs after a moveto are implicit linetos
+    Append(" ");
+    AppendValue(x2);
+    Append(" ");
+    AppendValue(y2);
+    ++path_points_;
+    last_x_ = x2;
+    last_y_ = y2;
+}
+
+void SvgDocument::Close() {
+    if (closed_) {
+        return;
+    }
+    ClosePath();
+    Append("</svg>\n");
+    FlushBuffer();
+    stream_.close();
+    closed_ = true;
+}
+
+SvgDocument::~SvgDocument() noexcept {
     try {
-        boost::property_tree::write_xml(filename, tree_);
+        Close();
     } catch (std::exception& e) {
-        BOOST_LOG_TRIVIAL(error) << "Caught exception when building SVG document " << filename
+        BOOST_LOG_TRIVIAL(error) << "Caught exception when closing SVG document " << filename_
                                  << ": " << e.what();
-        throw;
     }
 }
 
-std::string SvgDocument::FormatValue(long double v) { return std::to_string(v); }
+template <typename T>
+void SvgDocument::AppendValue(T v) {
+    // Find the shortest representation that is parsed back to the same value.
+    // Any value that can be written with less than digits10 digits is found by rounding
+    // to digits10 digits and removing trailing zeros.
+    char str[48];
+    if (v == 0 || !std::isfinite(v)) {
+        int length = std::snprintf(str, sizeof(str), "%g", static_cast<double>(v));
+        Append(str, static_cast<size_t>(length));
+        return;
+    }
+    // Digits of subnormal values (e.g. 5e-324 as double) would be calculated by scaling them
+    // with powers of ten which are out of double range, so they skip the shortest search
+    // and are written with max_digits10 (17 for double) significant digits
+    if (!std::isnormal(static_cast<double>(v))) {
+        int length = std::snprintf(
+            str, sizeof(str), "%.*g", std::numeric_limits<T>::max_digits10,
+            static_cast<double>(v));
+        Append(str, static_cast<size_t>(length));
+        return;
+    }
+    for (int precision = std::numeric_limits<T>::digits10;
+         precision <= std::numeric_limits<T>::max_digits10; ++precision) {
+        int length = FormatWithPrecision(str, static_cast<double>(v), precision);
+        if (ParseValue<T>(str) == v) {
+            Append(str, static_cast<size_t>(length));
+            return;
+        }
+    }
+    // Digits calculated with double precision may be inexact, fall back to standard library
+    int length = std::snprintf(
+        str, sizeof(str), "%.*g", std::numeric_limits<T>::max_digits10, static_cast<double>(v));
+    Append(str, static_cast<size_t>(length));
+}
+
+void SvgDocument::Append(const char* str) { Append(str, std::strlen(str)); }
+
+void SvgDocument::Append(const char* str, size_t length) {
+    if (buffer_.size() + length > buffer_size_) {
+        FlushBuffer();
+    }
+    buffer_.insert(buffer_.end(), str, str + length);
+}
+
+void SvgDocument::FlushBuffer() {
+    stream_.write(buffer_.data(), buffer_.size());
+    if (!stream_) {
+        BOOST_LOG_TRIVIAL(error) << "Cannot write SVG document " << filename_;
+        throw std::runtime_error("Cannot write SVG document " + filename_);
+    }
+    buffer_.clear();
+}
+
+void SvgDocument::ClosePath() {
+    if (path_open_) {
+        Append("\"/>\n");
+        path_open_ = false;
+    }
+}
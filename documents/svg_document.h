@@ -1,21 +1,59 @@
 #pragma once
 
-#include <boost/property_tree/ptree.hpp>
+#include <fstream>
+#include <string>
+#include <vector>
 
+/*
+SVG document that is written to disk while it is being built, so memory consumption
+doesn't depend on document size.
+Data is collected in a large buffer and written by big blocks.
+Numbers are written in the shortest form that is converted back to the same value.
+
+In path data mode lines are written as polylines (path elements) instead of one line element
+per line. A line that starts where the previous one ended continues current polyline.
+*/
 class SvgDocument {
 public:
-    SvgDocument();
+    // Creates a file and writes document header
+    SvgDocument(
+        const std::string& filename, double width, double height, bool use_path_data = false);
 
     /*
         Add line that starts at (x1, y1) and ends at (x2, y2)
     */
-    void AddLine(long double x1, long double y1, long double x2, long double y2);
-    void SetSize(long double width, long double height);
+    void AddLine(float x1, float y1, float x2, float y2);
+    void AddLine(double x1, double y1, double x2, double y2);
+
+    // Writes the end of the document and closes the file.
+    void Close();
 
-    void BuildAndWriteToDisk(const std::string& filename);
+    ~SvgDocument() noexcept;
 
 private:
-    boost::property_tree::ptree tree_;
+    template <typename T>
+    void AddLineImpl(T x1, T y1, T x2, T y2);
+
+    template <typename T>
+    void AppendValue(T v);
+
+    void Append(const char* str);
+    void Append(const char* str, size_t length);
+    void FlushBuffer();
+    void ClosePath();
+
+    static constexpr size_t buffer_size_ = 1 << 20;
+    // Max number of points in one path element, some viewers don't handle long paths well
+    static constexpr size_t max_path_points_ = 10000;
 
-    std::string FormatValue(long double v);
+    std::string filename_;
+    std::ofstream stream_;
+    std::vector<char> buffer_;
+    bool use_path_data_;
+    bool closed_ = false;
+    // State of current path (only in path data mode)
+    bool path_open_ = false;
+    size_t path_points_ = 0;
+    double last_x_ = 0.0;
+    double last_y_ = 0.0;
 };
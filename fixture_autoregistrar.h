@@ -11,6 +11,15 @@ public:
     FixtureAutoregistrar(const std::string& category_id, FixtureFactory fixture_factory) {
         FixtureRegistry::instance().Register(category_id, fixture_factory);
     }
+
+    FixtureAutoregistrar(
+        const std::string& category_id, const std::string& sweep_name,
+        FixtureRegistry::SizedFixtureFactory fixture_factory, int32_t min_element_count,
+        int32_t max_element_count, double ratio) {
+        FixtureRegistry::instance().RegisterSweep(
+            category_id, sweep_name, fixture_factory, min_element_count, max_element_count,
+            ratio);
+    }
 };
 }  //  namespace kpv
 
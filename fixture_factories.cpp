@@ -1,29 +1,30 @@
+#include <boost/format.hpp>
 #include <boost/math/constants/constants.hpp>
 #include <boost/random/normal_distribution.hpp>
+#include <numeric>
 
 #include "devices/platform_list.h"
 #include "documents/csv_document.h"
 #include "documents/svg_document.h"
 #include "fixture_register_macros.h"
 #include "fixtures/damped_wave_opencl_fixture.h"
+#include "fixtures/device_input_generator.h"
 #include "fixtures/fixture_family.h"
 #include "fixtures/koch_curve_opencl_fixture.h"
+#include "fixtures/launch_overhead_opencl_fixture.h"
+#include "fixtures/memory_bandwidth_opencl_fixture.h"
 #include "fixtures/multibrot_opencl_fixture.h"
 #include "fixtures/trivial_factorial_opencl_fixture.h"
 #include "half_precision_fp.h"
 #include "half_precision_normal_distribution.h"
+#include "iterators/cyclic_values_iterator.h"
 #include "iterators/random_values_iterator.h"
 #include "iterators/sequential_values_iterator.h"
+#include "opencl_type_traits.h"
 
 #if 0
 std::vector<std::shared_ptr<FixtureFamily>> CreateTrivialFixtures(
     const PlatformList& platform_list);
-template <typename T, typename D = std::normal_distribution<T>>
-std::vector<std::shared_ptr<FixtureFamily>> CreateDampedWave2DFixtures(
-    const PlatformList& platform_list);
-template <typename T, typename T4>
-std::vector<std::shared_ptr<FixtureFamily>> CreateKochCurveFixtures(
-    const PlatformList& platform_list);
 template <typename T, typename P>
 std::vector<std::shared_ptr<FixtureFamily>> FixtureRunner::CreateMultibrotSetFixtures(
     const PlatformList& platform_list);
@@ -70,178 +71,84 @@ template <>
 struct MultibrotResultConstants<cl_ushort> {
     static constexpr const char* pixel_type_description = "grayscale 16 bit";
 };
-}  // namespace
-
-std::shared_ptr<FixtureFamily> CreateTrivialFactorialFixtures(
-    const kpv::PlatformList& platform_list, int32_t data_size) {
-    auto fixture_family = std::make_shared<FixtureFamily>();
-    fixture_family->name =
-        "Trivial factorial, " + Utils::FormatQuantityString(data_size) + " elements";
-    fixture_family->element_count = data_size;
-    for (auto& platform : platform_list.OpenClPlatforms()) {
-        for (auto& device : platform->GetDevices()) {
-            typedef std::uniform_int_distribution<int> Distribution;
-            typedef RandomValuesIterator<int, Distribution> Iterator;
-            fixture_family->fixtures.insert(
-                std::make_pair<const FixtureId, std::shared_ptr<Fixture>>(
-                    FixtureId(fixture_family->name, device, ""),
-                    std::make_shared<TrivialFactorialOpenClFixture>(
-                        std::dynamic_pointer_cast<OpenClDevice>(device),
-                        std::make_shared<Iterator>(Distribution(0, 20)), data_size)));
-        }
-    }
-    return fixture_family;
-}
 
-REGISTER_FIXTURE(
-    "trivial-factorial", std::bind(&CreateTrivialFactorialFixtures, ::std::placeholders::_1, 100));
-REGISTER_FIXTURE(
-    "trivial-factorial", std::bind(&CreateTrivialFactorialFixtures, ::std::placeholders::_1, 1000));
-REGISTER_FIXTURE(
-    "trivial-factorial",
-    std::bind(&CreateTrivialFactorialFixtures, ::std::placeholders::_1, 100000));
-REGISTER_FIXTURE(
-    "trivial-factorial",
-    std::bind(&CreateTrivialFactorialFixtures, ::std::placeholders::_1, 1000000));
+// Max input value of factorial fixtures, factorial of larger values doesn't fit into cl_ulong
+constexpr int kMaxFactorialInput = 20;
 
-#if 0
-template <typename T, typename D = std::normal_distribution<T>>
-std::vector<std::shared_ptr<FixtureFamily>> CreateDampedWave2DFixtures(
-    const PlatformList& platform_list) {
-    T frequency = static_cast<T>(1.0);
-    const T pi = boost::math::constants::pi<T>();
+// Distributions of factorial input, which cause different divergence of work items
+enum class FactorialInput {
+    // All values are the max one, no divergence
+    kConstant,
+    // All values in ascending order, neighbour work items almost always have the same value
+    kSorted,
+    kUniformRandom,
+    // The max value followed by 7 zeros, so every SIMD group of 8 or more work items has
+    // the longest loop, while average work is small
+    kInterleaved
+};
 
-    T min = static_cast<T>(-10.0);
-    T max = static_cast<T>(10.0);
-    T step = static_cast<T>(0.001);
-    // TODO change to int32_t?
-    size_t data_size =
-        static_cast<size_t>((max - min) / step);  // TODO something similar can be useful in Utils
-
-    std::mt19937 randomValueGenerator;
-    {
-        std::vector<DampedWaveFixtureParameters<T>> params = {DampedWaveFixtureParameters<T>{
-            static_cast<T>(1000.0), static_cast<T>(0.1), static_cast<T>(2 * pi * frequency),
-            static_cast<T>(0.0), static_cast<T>(1.0)}};
-        auto fixture_family = std::make_shared<FixtureFamily>();
-        fixture_family->name =
-            (boost::format("Damped wave, %1%, %2% values, %3% parameters, sequential input data") %
-             OpenClTypeTraits<T>::short_description % Utils::FormatQuantityString(data_size) %
-             Utils::FormatQuantityString(params.size()))
-                .str();
-        fixture_family->element_count = data_size;
-        for (auto& platform : platform_list_.OpenClPlatforms()) {
-            for (auto& device : platform->GetDevices()) {
-                fixture_family->fixtures.insert(
-                    std::make_pair<const FixtureId, std::shared_ptr<Fixture>>(
-                        FixtureId(fixture_family->name, device, ""),
-                        std::make_shared<DampedWaveOpenClFixture<T>>(
-                            std::dynamic_pointer_cast<OpenClDevice>(device), params,
-                            std::make_shared<SequentialValuesIterator<T>>(min, step), data_size,
-                            fixture_family->name)));
-            }
-        }
-        fixture_families_.push_back(fixture_family);
-    }
-    {
-        std::vector<DampedWaveFixtureParameters<T>> params = {DampedWaveFixtureParameters<T>{
-            static_cast<T>(1000.0), static_cast<T>(0.1), static_cast<T>(2 * pi * frequency),
-            static_cast<T>(0.0), static_cast<T>(1.0)}};
-        auto fixture_family = std::make_shared<FixtureFamily>();
-        fixture_family->name =
-            (boost::format("Damped wave, %1%, %2% values, %3% parameters, random input data") %
-             OpenClTypeTraits<T>::short_description % Utils::FormatQuantityString(data_size) %
-             Utils::FormatQuantityString(params.size()))
-                .str();
-        fixture_family->element_count = data_size;
-        for (auto& platform : platform_list_.OpenClPlatforms()) {
-            for (auto& device : platform->GetDevices()) {
-                fixture_family->fixtures.insert(
-                    std::make_pair<const FixtureId, std::shared_ptr<Fixture>>(
-                        FixtureId(fixture_family->name, device, ""),
-                        std::make_shared<DampedWaveOpenClFixture<T>>(
-                            std::dynamic_pointer_cast<OpenClDevice>(device), params,
-                            std::make_shared<RandomValuesIterator<T, D>>(
-                                D(static_cast<T>(0.0), static_cast<T>(100.0))),
-                            data_size, fixture_family->name)));
-            }
-        }
-        fixture_families_.push_back(fixture_family);
+std::string GetFactorialInputDescription(FactorialInput input) {
+    switch (input) {
+        case FactorialInput::kConstant:
+            return "constant";
+        case FactorialInput::kSorted:
+            return "sorted";
+        case FactorialInput::kInterleaved:
+            return "interleaved";
+        case FactorialInput::kUniformRandom:
+        default:
+            return "uniform random";
     }
-    {
-        const size_t paramsCount = 1000;
-        std::vector<DampedWaveFixtureParameters<T>> params;
-        auto rand = std::bind(D(static_cast<T>(0.0), static_cast<T>(10.0)), randomValueGenerator);
-        std::generate_n(std::back_inserter(params), paramsCount, [&rand]() {
-            return DampedWaveFixtureParameters<T>(
-                rand(), static_cast<T>(0.01), rand(), rand() - static_cast<T>(5.0),
-                rand() - static_cast<T>(5.0));
-        });
-        auto fixture_family = std::make_shared<FixtureFamily>();
-        fixture_family->name =
-            (boost::format("Damped wave, %1%, %2% values, %3% parameters, sequential input data") %
-             OpenClTypeTraits<T>::short_description % Utils::FormatQuantityString(data_size) %
-             Utils::FormatQuantityString(params.size()))
-                .str();
-        fixture_family->element_count = data_size;
-        for (auto& platform : platform_list_.OpenClPlatforms()) {
-            for (auto& device : platform->GetDevices()) {
-                fixture_family->fixtures.insert(
-                    std::make_pair<const FixtureId, std::shared_ptr<Fixture>>(
-                        FixtureId(fixture_family->name, device, ""),
-                        std::make_shared<DampedWaveOpenClFixture<T>>(
-                            std::dynamic_pointer_cast<OpenClDevice>(device), params,
-                            std::make_shared<SequentialValuesIterator<T>>(min, step), data_size,
-                            fixture_family->name)));
-            }
-        }
-        fixture_families_.push_back(fixture_family);
-    }
-    {
-        const size_t paramsCount = 1000;
-        std::vector<DampedWaveFixtureParameters<T>> params;
-        auto rand = std::bind(D(static_cast<T>(0.0), static_cast<T>(10.0)), randomValueGenerator);
-        std::generate_n(std::back_inserter(params), paramsCount, [&rand]() {
-            return DampedWaveFixtureParameters<T>(
-                rand(), static_cast<T>(0.01), rand(), rand() - static_cast<T>(5.0),
-                rand() - static_cast<T>(5.0));
-        });
-        auto fixture_family = std::make_shared<FixtureFamily>();
-        fixture_family->name =
-            (boost::format("Damped wave, %1%, %2% values, %3% parameters, random input data") %
-             OpenClTypeTraits<T>::short_description % Utils::FormatQuantityString(data_size) %
-             Utils::FormatQuantityString(params.size()))
-                .str();
-        fixture_family->element_count = data_size;
-        for (auto& platform : platform_list_.OpenClPlatforms()) {
-            for (auto& device : platform->GetDevices()) {
-                fixture_family->fixtures.insert(
-                    std::make_pair<const FixtureId, std::shared_ptr<Fixture>>(
-                        FixtureId(fixture_family->name, device, ""),
-                        std::make_shared<DampedWaveOpenClFixture<T>>(
-                            std::dynamic_pointer_cast<OpenClDevice>(device), params,
-                            std::make_shared<RandomValuesIterator<T, D>>(
-                                D(static_cast<T>(0.0), static_cast<T>(100.0))),
-                            data_size, fixture_family->name)));
-            }
+}
+
+std::shared_ptr<DataSource<int>> CreateFactorialInputDataSource(
+    FactorialInput input, int32_t data_size) {
+    switch (input) {
+        case FactorialInput::kConstant:
+            return std::make_shared<SequentialValuesIterator<int>>(kMaxFactorialInput, 0);
+        case FactorialInput::kSorted: {
+            std::vector<int> values(kMaxFactorialInput + 1);
+            std::iota(values.begin(), values.end(), 0);
+            const size_t repeat_count = (data_size + values.size() - 1) / values.size();
+            return std::make_shared<CyclicValuesIterator<int>>(values, repeat_count);
         }
-        fixture_families_.push_back(fixture_family);
+        case FactorialInput::kInterleaved:
+            return std::make_shared<CyclicValuesIterator<int>>(
+                std::vector<int>{kMaxFactorialInput, 0, 0, 0, 0, 0, 0, 0});
+        case FactorialInput::kUniformRandom:
+        default:
+            typedef std::uniform_int_distribution<int> Distribution;
+            return std::make_shared<RandomValuesIterator<int, Distribution>>(
+                Distribution(0, kMaxFactorialInput));
     }
 }
 
-template <typename T, typename T4>
-std::vector<std::shared_ptr<FixtureFamily>> CreateKochCurveFixtures(
-    const PlatformList& platform_list) {
-    // TODO it would be great to get images with higher number of iterations but
-    // another output method is needed (SVG doesn't work well)
-    const std::vector<int> iteration_count_variants = {1, 3, 7};
-    struct CurveVariant {
-        std::vector<cl_double4> curves;
-        std::string description;
-    };
-
-    std::vector<CurveVariant> curve_variants;
-    {
+// Where input data of fixtures is generated
+enum class InputGeneration {
+    // On host, it is copied to a device by every iteration
+    kHost,
+    // On a device once, before iterations, large inputs don't need host memory and a copy
+    kDevice
+};
+
+// Numbers of chunks of pipelined fixtures, every number is a separate algorithm variant, so
+// the best one for a device is found by algorithm comparison
+const std::vector<size_t> kPipelineChunkCounts = {2, 4, 8, 16, 32};
+
+// Max number of Koch curve iterations which results are kept in memory entirely
+constexpr int kMaxStoredKochCurveIterations = 10;
+// Max number of Koch curve iterations which lines are streamed back to host, every iteration
+// multiplies a number of lines (and bytes read back) by 4
+constexpr int kMaxStreamedKochCurveIterations = 12;
+
+struct KochCurveVariant {
+    std::vector<cl_double4> curves;
+    std::string description;
+};
+
+const std::vector<KochCurveVariant>& GetKochCurveVariants() {
+    static std::vector<KochCurveVariant> curve_variants;
+    if (curve_variants.empty()) {
         std::vector<cl_double4> singleCurve = {{0.0, 0.0, 1000.0, 0.0}};
         std::vector<cl_double4> twoCurvesFace2Face = {{0.0, 0.0, 1000.0, 0.0},
                                                       {1000.0, 300.0, 0.0, 300.0}};
@@ -278,67 +185,502 @@ std::vector<std::shared_ptr<FixtureFamily>> CreateKochCurveFixtures(
                           {snowflakeSquareCurves, "square"},
                           {snowflakeSomeFigure, "some figure"}};
     }
+    return curve_variants;
+}
 
-    for (int iterations : iteration_count_variants) {
-        for (const auto& curve_variant : curve_variants) {
-            auto fixture_family = std::make_shared<FixtureFamily>();
-            fixture_family->name =
-                (boost::format("Koch curve, %1%, %2% iterations, %3%") %
-                 OpenClTypeTraits<T>::short_description % iterations % curve_variant.description)
-                    .str();
-            // TODO fixture_family->element_count can be calculated but is not trivial
-
-            std::vector<T4> casted_curves;
-            std::transform(
-                curve_variant.curves.cbegin(), curve_variant.curves.cend(),
-                std::back_inserter(casted_curves), [](const cl_double4& v) -> T4 {
-                    return Utils::StaticCastVector4<T4, cl_double4>(v);
-                });
+// Size in the largest binary unit which it is a multiple of, e.g. "4 KB" or "1 GB"
+std::string FormatByteSize(int32_t size) {
+    const std::vector<const char*> units = {"bytes", "KB", "MB", "GB"};
+    size_t unit = 0;
+    while (unit + 1 < units.size() && size % 1024 == 0) {
+        size /= 1024;
+        ++unit;
+    }
+    return std::to_string(size) + " " + units[unit];
+}
+}  // namespace
 
-            for (auto& platform : platform_list_.OpenClPlatforms()) {
-                for (auto& device : platform->GetDevices()) {
-                    fixture_family->fixtures.insert(
-                        std::make_pair<const FixtureId, std::shared_ptr<Fixture>>(
-                            FixtureId(fixture_family->name, device, ""),
-                            std::make_shared<KochCurveOpenClFixture<T, T4>>(
-                                std::dynamic_pointer_cast<OpenClDevice>(device), iterations,
-                                casted_curves, 1000.0, 1000.0, fixture_family->name)));
-                }
-            }
-            fixture_families_.push_back(fixture_family);
+std::shared_ptr<FixtureFamily> CreateTrivialFactorialFixtures(
+    const kpv::PlatformList& platform_list, int32_t data_size, FactorialInput input) {
+    auto fixture_family = std::make_shared<FixtureFamily>();
+    fixture_family->name = "Trivial factorial, " + Utils::FormatQuantityString(data_size) +
+                           " elements, " + GetFactorialInputDescription(input) + " input";
+    fixture_family->element_count = data_size;
+    const std::vector<TrivialFactorialAlgorithm> algorithms = {
+        TrivialFactorialAlgorithm::kLoop, TrivialFactorialAlgorithm::kLookupTable};
+    auto input_data_source = CreateFactorialInputDataSource(input, data_size);
+    InputDataKey input_data_key;
+    input_data_key.description = GetFactorialInputDescription(input);
+    input_data_key.size = data_size;
+    if (input == FactorialInput::kUniformRandom) {
+        // Random values iterator of the data source uses the default seed
+        input_data_key.seed = GetDefaultRandomSeed();
+    }
+    const CachedInputData<int> input_data(
+        input_data_source, input_data_key, fixture_family->input_data_cache);
+    for (auto& platform : platform_list.OpenClPlatforms()) {
+        for (auto& device : platform->GetDevices()) {
+            auto opencl_device = std::dynamic_pointer_cast<OpenClDevice>(device);
+            fixture_family->AddAlgorithmVariants(
+                device, algorithms, &TrivialFactorialOpenClFixture::AlgorithmName,
+                [opencl_device, input_data](TrivialFactorialAlgorithm algorithm) {
+                    return std::make_shared<TrivialFactorialOpenClFixture>(
+                        opencl_device, input_data, algorithm);
+                });
+            fixture_family->AddAlgorithmVariants(
+                device, kPipelineChunkCounts,
+                &TrivialFactorialOpenClFixture::PipelinedAlgorithmName,
+                [opencl_device, input_data](size_t chunk_count) {
+                    return std::make_shared<TrivialFactorialOpenClFixture>(
+                        opencl_device, input_data, TrivialFactorialAlgorithm::kPipelined,
+                        chunk_count);
+                });
         }
     }
+    return fixture_family;
 }
 
+// Element counts from 100 to 1M, two per decade
+REGISTER_FIXTURE_SWEEP(
+    "trivial-factorial", "Trivial factorial",
+    std::bind(
+        &CreateTrivialFactorialFixtures, ::std::placeholders::_1, ::std::placeholders::_2,
+        FactorialInput::kUniformRandom),
+    100, 1000000, std::sqrt(10.0));
+// Input distributions show how devices handle divergence of work items
+REGISTER_FIXTURE(
+    "trivial-factorial",
+    std::bind(
+        &CreateTrivialFactorialFixtures, ::std::placeholders::_1, 1000000,
+        FactorialInput::kConstant));
+REGISTER_FIXTURE(
+    "trivial-factorial",
+    std::bind(
+        &CreateTrivialFactorialFixtures, ::std::placeholders::_1, 1000000,
+        FactorialInput::kSorted));
+REGISTER_FIXTURE(
+    "trivial-factorial",
+    std::bind(
+        &CreateTrivialFactorialFixtures, ::std::placeholders::_1, 1000000,
+        FactorialInput::kInterleaved));
+
 template <typename T, typename P>
-std::vector<std::shared_ptr<FixtureFamily>> CreateMultibrotSetFixtures(
-    const PlatformList& platform_list) {
-    std::vector<double> powers = {1.0, 2.0, 3.0, 7.0, 3.5, 0.1, 0.5};
+std::shared_ptr<FixtureFamily> CreateMultibrotSetFixtures(
+    const kpv::PlatformList& platform_list, double power) {
     std::complex<double> min{-2.5, -2.0};
     std::complex<double> max{1.5, 2.0};
-    for (double power : powers) {
-        auto fixture_family = std::make_shared<FixtureFamily>();
-        fixture_family->name = (boost::format("%1%, %3%, %4%") %
-                                ((power == 2.0) ? std::string("Mandelbrot set")
-                                                : "Multibrot set, power " + std::to_string(power)) %
-                                power % OpenClTypeTraits<T>::short_description %
-                                MultibrotResultConstants<P>::pixel_type_description)
-                                   .str();
-        fixture_family->element_count =
-            MultibrotSetParams<T>::width_pix * MultibrotSetParams<T>::height_pix;
-
-        for (auto& platform : platform_list_.OpenClPlatforms()) {
-            for (auto& device : platform->GetDevices()) {
-                fixture_family->fixtures.insert(
-                    std::make_pair<const FixtureId, std::shared_ptr<Fixture>>(
-                        FixtureId(fixture_family->name, device, ""),
-                        std::make_shared<MultibrotOpenClFixture<T, P>>(
-                            std::dynamic_pointer_cast<OpenClDevice>(device),
-                            MultibrotSetParams<T>::width_pix, MultibrotSetParams<T>::height_pix,
-                            min, max, power, fixture_family->name)));
+    auto fixture_family = std::make_shared<FixtureFamily>();
+    fixture_family->name = (boost::format("%1%, %2%, %3%") %
+                            ((power == 2.0) ? std::string("Mandelbrot set")
+                                            : "Multibrot set, power " + std::to_string(power)) %
+                            OpenClTypeTraits<T>::short_description %
+                            MultibrotResultConstants<P>::pixel_type_description)
+                               .str();
+    fixture_family->element_count =
+        MultibrotSetParams<T>::width_pix * MultibrotSetParams<T>::height_pix;
+
+    // Every device runs the universal kernel and kernels specialized for a given power (only if
+    // there is a specialized function for it), with max iteration number given as an argument
+    // or fixed at compile time
+    std::vector<bool> specialization_variants = {false};
+    if (HasSpecializedPowerFunction(power)) {
+        specialization_variants.push_back(true);
+    }
+    std::vector<MultibrotKernelOptions> kernel_variants;
+    for (bool fixed_max_iterations : {false, true}) {
+        for (bool specialize_integer_powers : specialization_variants) {
+            MultibrotKernelOptions options;
+            options.specialize_integer_powers = specialize_integer_powers;
+            options.fixed_max_iterations = fixed_max_iterations;
+            kernel_variants.push_back(options);
+        }
+    }
+
+    const std::string fixture_name = fixture_family->name;
+    for (auto& platform : platform_list.OpenClPlatforms()) {
+        for (auto& device : platform->GetDevices()) {
+            auto opencl_device = std::dynamic_pointer_cast<OpenClDevice>(device);
+            fixture_family->AddAlgorithmVariants(
+                device, kernel_variants, &MultibrotOpenClFixture<T, P>::AlgorithmName,
+                [opencl_device, min, max, power,
+                 fixture_name](const MultibrotKernelOptions& options) {
+                    return std::make_shared<MultibrotOpenClFixture<T, P>>(
+                        opencl_device, MultibrotSetParams<T>::width_pix,
+                        MultibrotSetParams<T>::height_pix, min, max, power, options,
+                        fixture_name);
+                });
+        }
+    }
+    return fixture_family;
+}
+
+REGISTER_FIXTURE(
+    "multibrot",
+    std::bind(&CreateMultibrotSetFixtures<float, cl_uchar>, ::std::placeholders::_1, 1.0));
+REGISTER_FIXTURE(
+    "multibrot",
+    std::bind(&CreateMultibrotSetFixtures<float, cl_uchar>, ::std::placeholders::_1, 2.0));
+REGISTER_FIXTURE(
+    "multibrot",
+    std::bind(&CreateMultibrotSetFixtures<float, cl_uchar>, ::std::placeholders::_1, 3.0));
+REGISTER_FIXTURE(
+    "multibrot",
+    std::bind(&CreateMultibrotSetFixtures<float, cl_uchar>, ::std::placeholders::_1, 7.0));
+REGISTER_FIXTURE(
+    "multibrot",
+    std::bind(&CreateMultibrotSetFixtures<float, cl_uchar>, ::std::placeholders::_1, 3.5));
+REGISTER_FIXTURE(
+    "multibrot",
+    std::bind(&CreateMultibrotSetFixtures<float, cl_uchar>, ::std::placeholders::_1, 0.1));
+REGISTER_FIXTURE(
+    "multibrot",
+    std::bind(&CreateMultibrotSetFixtures<float, cl_uchar>, ::std::placeholders::_1, 0.5));
+
+template <typename T, typename T4>
+std::shared_ptr<FixtureFamily> CreateKochCurveFixtures(
+    const kpv::PlatformList& platform_list, int iterations,
+    const std::string& curve_variant_description) {
+    const auto& curve_variants = GetKochCurveVariants();
+    auto curve_variant = std::find_if(
+        curve_variants.cbegin(), curve_variants.cend(), [&](const KochCurveVariant& v) {
+            return v.description == curve_variant_description;
+        });
+    EXCEPTION_ASSERT(curve_variant != curve_variants.cend());
+
+    auto fixture_family = std::make_shared<FixtureFamily>();
+    fixture_family->name =
+        (boost::format("Koch curve, %1%, %2% iterations, %3%") %
+         OpenClTypeTraits<T>::short_description % iterations % curve_variant->description)
+            .str();
+    // TODO fixture_family->element_count can be calculated but is not trivial
+
+    std::vector<T4> casted_curves;
+    std::transform(
+        curve_variant->curves.cbegin(), curve_variant->curves.cend(),
+        std::back_inserter(casted_curves),
+        [](const cl_double4& v) -> T4 { return Utils::StaticCastVector4<T4, cl_double4>(v); });
+
+    // Only streaming algorithm can handle large iteration counts, its lines are rasterized
+    // on device, because SVG doesn't work well with so many lines
+    std::vector<std::pair<KochCurveAlgorithm, KochCurveOutput>> algorithms = {
+        {KochCurveAlgorithm::kStreaming, KochCurveOutput::kImage}};
+    // Number of lines produced by adaptive algorithm is limited by viewport resolution
+    algorithms.push_back({KochCurveAlgorithm::kAdaptive, KochCurveOutput::kLines});
+    if (iterations <= kMaxStreamedKochCurveIterations) {
+        algorithms.push_back({KochCurveAlgorithm::kStreaming, KochCurveOutput::kLines});
+    }
+    if (iterations <= kMaxStoredKochCurveIterations) {
+        algorithms.push_back({KochCurveAlgorithm::kPrecalculation, KochCurveOutput::kLines});
+        algorithms.push_back({KochCurveAlgorithm::kDirect, KochCurveOutput::kLines});
+        algorithms.push_back({KochCurveAlgorithm::kDirect, KochCurveOutput::kImage});
+    }
+
+    typedef std::pair<KochCurveAlgorithm, KochCurveOutput> Algorithm;
+    const std::string fixture_name = fixture_family->name;
+    for (auto& platform : platform_list.OpenClPlatforms()) {
+        for (auto& device : platform->GetDevices()) {
+            auto opencl_device = std::dynamic_pointer_cast<OpenClDevice>(device);
+            fixture_family->AddAlgorithmVariants(
+                device, algorithms,
+                [](const Algorithm& algorithm) {
+                    return KochCurveOpenClFixture<T, T4>::AlgorithmName(
+                        algorithm.first, algorithm.second);
+                },
+                [opencl_device, iterations, casted_curves,
+                 fixture_name](const Algorithm& algorithm) {
+                    return std::make_shared<KochCurveOpenClFixture<T, T4>>(
+                        opencl_device, iterations, casted_curves, 1000.0, 1000.0, fixture_name,
+                        algorithm.first, algorithm.second);
+                });
+        }
+    }
+    return fixture_family;
+}
+
+REGISTER_FIXTURE(
+    "koch-curve", std::bind(
+                      &CreateKochCurveFixtures<float, cl_float4>, ::std::placeholders::_1, 1,
+                      "single curve"));
+REGISTER_FIXTURE(
+    "koch-curve", std::bind(
+                      &CreateKochCurveFixtures<float, cl_float4>, ::std::placeholders::_1, 3,
+                      "single curve"));
+REGISTER_FIXTURE(
+    "koch-curve", std::bind(
+                      &CreateKochCurveFixtures<float, cl_float4>, ::std::placeholders::_1, 7,
+                      "single curve"));
+REGISTER_FIXTURE(
+    "koch-curve",
+    std::bind(
+        &CreateKochCurveFixtures<float, cl_float4>, ::std::placeholders::_1, 1, "triangle"));
+REGISTER_FIXTURE(
+    "koch-curve",
+    std::bind(
+        &CreateKochCurveFixtures<float, cl_float4>, ::std::placeholders::_1, 3, "triangle"));
+REGISTER_FIXTURE(
+    "koch-curve",
+    std::bind(
+        &CreateKochCurveFixtures<float, cl_float4>, ::std::placeholders::_1, 7, "triangle"));
+REGISTER_FIXTURE(
+    "koch-curve",
+    std::bind(
+        &CreateKochCurveFixtures<float, cl_float4>, ::std::placeholders::_1, 13, "triangle"));
+// Half precision is only good enough for a small number of iterations: ULP of coordinates near
+// 1000 is 0.5, lines of 7 iterations (about 0.37 px long) would collapse
+REGISTER_FIXTURE(
+    "koch-curve",
+    std::bind(
+        &CreateKochCurveFixtures<half_float::half, Half4>, ::std::placeholders::_1, 1,
+        "triangle"));
+REGISTER_FIXTURE(
+    "koch-curve",
+    std::bind(
+        &CreateKochCurveFixtures<half_float::half, Half4>, ::std::placeholders::_1, 3,
+        "triangle"));
+
+template <typename T, typename D = std::normal_distribution<T>>
+std::shared_ptr<FixtureFamily> CreateDampedWave2DFixtures(
+    const kpv::PlatformList& platform_list, size_t data_size, size_t params_count,
+    bool random_input, InputGeneration input_generation) {
+    T frequency = static_cast<T>(1.0);
+    const T pi = boost::math::constants::pi<T>();
+
+    T min = static_cast<T>(-10.0);
+    T max = static_cast<T>(10.0);
+    T step = (max - min) / static_cast<T>(data_size);
+
+    std::vector<DampedWaveFixtureParameters<T>> params;
+    if (params_count == 1) {
+        params = {DampedWaveFixtureParameters<T>{
+            static_cast<T>(1000.0), static_cast<T>(0.1), static_cast<T>(2 * pi * frequency),
+            static_cast<T>(0.0), static_cast<T>(1.0)}};
+    } else {
+        std::mt19937 randomValueGenerator;
+        auto rand = std::bind(D(static_cast<T>(0.0), static_cast<T>(10.0)), randomValueGenerator);
+        std::generate_n(std::back_inserter(params), params_count, [&rand]() {
+            return DampedWaveFixtureParameters<T>(
+                rand(), static_cast<T>(0.01), rand(), rand() - static_cast<T>(5.0),
+                rand() - static_cast<T>(5.0));
+        });
+    }
+
+    auto fixture_family = std::make_shared<FixtureFamily>();
+    fixture_family->name =
+        (boost::format("Damped wave, %1%, %2% values, %3% parameters, %4% input data") %
+         OpenClTypeTraits<T>::short_description % Utils::FormatQuantityString(data_size) %
+         Utils::FormatQuantityString(params.size()) % (random_input ? "random" : "sequential"))
+            .str();
+    if (input_generation == InputGeneration::kDevice) {
+        fixture_family->name += ", generated on device";
+    }
+    fixture_family->element_count = data_size;
+
+    // Every device runs a kernel for each memory space and layout of parameters
+    std::vector<DampedWaveAlgorithm> algorithms = {
+        DampedWaveAlgorithm::kGlobalMemory, DampedWaveAlgorithm::kLocalMemory,
+        DampedWaveAlgorithm::kConstantMemory, DampedWaveAlgorithm::kStructureOfArrays,
+        DampedWaveAlgorithm::kParameterBlocks};
+    if (!random_input) {
+        algorithms.push_back(DampedWaveAlgorithm::kRecurrence);
+    }
+
+    // Input data is generated once and shared by all fixtures of the family
+    std::shared_ptr<DataSource<T>> input_data_source;
+    InputDataKey input_data_key;
+    input_data_key.size = data_size;
+    if (input_generation == InputGeneration::kDevice) {
+        const DeviceInputDistribution distribution =
+            random_input ? DeviceInputDistribution::kNormal : DeviceInputDistribution::kSequential;
+        const double a = random_input ? 0.0 : static_cast<double>(min);
+        const double b = random_input ? 100.0 : static_cast<double>(step);
+        auto generator = std::make_shared<DeviceInputGenerator<T>>(distribution, a, b);
+        input_data_source = generator;
+        input_data_key.description =
+            (boost::format("generated on device, %1%, %2%, %3%") %
+             (random_input ? "normal" : "sequential") % a % b)
+                .str();
+        input_data_key.seed = random_input ? generator->seed() : 0;
+    } else if (random_input) {
+        const T mean = static_cast<T>(0.0);
+        const T standard_deviation = static_cast<T>(100.0);
+        auto random_values =
+            std::make_shared<RandomValuesIterator<T, D>>(D(mean, standard_deviation));
+        input_data_source = random_values;
+        input_data_key.description =
+            (boost::format("normal, mean %1%, standard deviation %2%") % mean %
+             standard_deviation)
+                .str();
+        input_data_key.seed = random_values->seed();
+    } else {
+        input_data_source = std::make_shared<SequentialValuesIterator<T>>(min, step);
+        input_data_key.description =
+            (boost::format("sequential from %1% with step %2%") % min % step).str();
+    }
+    const CachedInputData<T> input_data(
+        input_data_source, input_data_key, fixture_family->input_data_cache);
+
+    // Fixtures are created later, one by one, parameters are shared by their factories
+    auto shared_params =
+        std::make_shared<const std::vector<DampedWaveFixtureParameters<T>>>(std::move(params));
+    const std::string fixture_name = fixture_family->name;
+    for (auto& platform : platform_list.OpenClPlatforms()) {
+        for (auto& device : platform->GetDevices()) {
+            auto opencl_device = std::dynamic_pointer_cast<OpenClDevice>(device);
+            fixture_family->AddAlgorithmVariants(
+                device, algorithms, &DampedWaveOpenClFixture<T>::AlgorithmName,
+                [opencl_device, shared_params, input_data,
+                 fixture_name](DampedWaveAlgorithm algorithm) {
+                    return std::make_shared<DampedWaveOpenClFixture<T>>(
+                        opencl_device, *shared_params, input_data, fixture_name, algorithm);
+                });
+            // Input generated on a device isn't copied, so there is nothing to overlap
+            if (input_generation == InputGeneration::kHost) {
+                fixture_family->AddAlgorithmVariants(
+                    device, kPipelineChunkCounts,
+                    &DampedWaveOpenClFixture<T>::PipelinedAlgorithmName,
+                    [opencl_device, shared_params, input_data,
+                     fixture_name](size_t chunk_count) {
+                        return std::make_shared<DampedWaveOpenClFixture<T>>(
+                            opencl_device, *shared_params, input_data, fixture_name,
+                            DampedWaveAlgorithm::kPipelined, chunk_count);
+                    });
             }
         }
-        fixture_families_.push_back(fixture_family);
     }
+    return fixture_family;
 }
-#endif
+
+REGISTER_FIXTURE(
+    "damped-wave",
+    std::bind(
+        &CreateDampedWave2DFixtures<float>, ::std::placeholders::_1, 20000, 1, false,
+        InputGeneration::kHost));
+REGISTER_FIXTURE(
+    "damped-wave",
+    std::bind(
+        &CreateDampedWave2DFixtures<float>, ::std::placeholders::_1, 20000, 1, true,
+        InputGeneration::kHost));
+REGISTER_FIXTURE(
+    "damped-wave",
+    std::bind(
+        &CreateDampedWave2DFixtures<float>, ::std::placeholders::_1, 20000, 1000, false,
+        InputGeneration::kHost));
+REGISTER_FIXTURE(
+    "damped-wave",
+    std::bind(
+        &CreateDampedWave2DFixtures<float>, ::std::placeholders::_1, 20000, 1000, true,
+        InputGeneration::kHost));
+REGISTER_FIXTURE_SWEEP(
+    "damped-wave", "Damped wave, single-precision, 1000 parameters, sequential input data",
+    std::bind(
+        &CreateDampedWave2DFixtures<float>, ::std::placeholders::_1, ::std::placeholders::_2,
+        1000, false, InputGeneration::kHost),
+    1000, 100000, std::sqrt(10.0));
+// Few inputs and many parameters, one work item per input can't occupy a wide device
+REGISTER_FIXTURE(
+    "damped-wave",
+    std::bind(
+        &CreateDampedWave2DFixtures<float>, ::std::placeholders::_1, 1000, 100000, false,
+        InputGeneration::kHost));
+// Large inputs are generated on a device, generation on host and a copy would dominate setup
+REGISTER_FIXTURE(
+    "damped-wave",
+    std::bind(
+        &CreateDampedWave2DFixtures<float>, ::std::placeholders::_1, 16000000, 1, false,
+        InputGeneration::kDevice));
+REGISTER_FIXTURE(
+    "damped-wave",
+    std::bind(
+        &CreateDampedWave2DFixtures<float>, ::std::placeholders::_1, 16000000, 1, true,
+        InputGeneration::kDevice));
+
+// Element count of a family is a number of transferred bytes, so a sweep fits latency and
+// bandwidth as a fixed overhead and a cost per byte
+std::shared_ptr<FixtureFamily> CreateMemoryBandwidthFixtures(
+    const kpv::PlatformList& platform_list, int32_t size, TransferDirection direction) {
+    auto fixture_family = std::make_shared<FixtureFamily>();
+    fixture_family->name = "Memory bandwidth, " +
+                           MemoryBandwidthOpenClFixture::DirectionName(direction) + ", " +
+                           FormatByteSize(size);
+    fixture_family->element_count = size;
+    const std::vector<TransferMethod> methods =
+        MemoryBandwidthOpenClFixture::GetTransferMethods(direction);
+    for (auto& platform : platform_list.OpenClPlatforms()) {
+        for (auto& device : platform->GetDevices()) {
+            auto opencl_device = std::dynamic_pointer_cast<OpenClDevice>(device);
+            fixture_family->AddAlgorithmVariants(
+                device, methods, &MemoryBandwidthOpenClFixture::AlgorithmName,
+                [opencl_device, size, direction](TransferMethod method) {
+                    return std::make_shared<MemoryBandwidthOpenClFixture>(
+                        opencl_device, size, direction, method);
+                });
+        }
+    }
+    return fixture_family;
+}
+
+// Sizes from 4 KB to 1 GB, every power of 4
+REGISTER_FIXTURE_SWEEP(
+    "memory-bandwidth", "Memory bandwidth, host to device",
+    std::bind(
+        &CreateMemoryBandwidthFixtures, ::std::placeholders::_1, ::std::placeholders::_2,
+        TransferDirection::kHostToDevice),
+    4096, 1 << 30, 4.0);
+REGISTER_FIXTURE_SWEEP(
+    "memory-bandwidth", "Memory bandwidth, device to host",
+    std::bind(
+        &CreateMemoryBandwidthFixtures, ::std::placeholders::_1, ::std::placeholders::_2,
+        TransferDirection::kDeviceToHost),
+    4096, 1 << 30, 4.0);
+REGISTER_FIXTURE_SWEEP(
+    "memory-bandwidth", "Memory bandwidth, device to device",
+    std::bind(
+        &CreateMemoryBandwidthFixtures, ::std::placeholders::_1, ::std::placeholders::_2,
+        TransferDirection::kDeviceToDevice),
+    4096, 1 << 30, 4.0);
+
+// Cases measure different costs, so every case is a separate family
+std::shared_ptr<FixtureFamily> CreateLaunchOverheadFixtures(
+    const kpv::PlatformList& platform_list, LaunchOverheadCase launch_case, size_t count) {
+    auto fixture_family = std::make_shared<FixtureFamily>();
+    fixture_family->name =
+        "Kernel launch overhead, " + LaunchOverheadOpenClFixture::AlgorithmName(launch_case, count);
+    for (auto& platform : platform_list.OpenClPlatforms()) {
+        for (auto& device : platform->GetDevices()) {
+            auto opencl_device = std::dynamic_pointer_cast<OpenClDevice>(device);
+            fixture_family->AddFixture(
+                device, LaunchOverheadOpenClFixture::AlgorithmName(launch_case, count),
+                [opencl_device, launch_case, count]() {
+                    return std::make_shared<LaunchOverheadOpenClFixture>(
+                        opencl_device, launch_case, count);
+                });
+        }
+    }
+    return fixture_family;
+}
+
+REGISTER_FIXTURE(
+    "launch-overhead",
+    std::bind(
+        &CreateLaunchOverheadFixtures, ::std::placeholders::_1, LaunchOverheadCase::kEmptyKernel,
+        1));
+REGISTER_FIXTURE(
+    "launch-overhead",
+    std::bind(
+        &CreateLaunchOverheadFixtures, ::std::placeholders::_1,
+        LaunchOverheadCase::kKernelArguments, 8));
+REGISTER_FIXTURE(
+    "launch-overhead",
+    std::bind(
+        &CreateLaunchOverheadFixtures, ::std::placeholders::_1,
+        LaunchOverheadCase::kKernelArguments, 64));
+REGISTER_FIXTURE(
+    "launch-overhead",
+    std::bind(
+        &CreateLaunchOverheadFixtures, ::std::placeholders::_1, LaunchOverheadCase::kBackToBack,
+        100));
+REGISTER_FIXTURE(
+    "launch-overhead",
+    std::bind(
+        &CreateLaunchOverheadFixtures, ::std::placeholders::_1, LaunchOverheadCase::kRoundTrip,
+        1));
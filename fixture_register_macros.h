@@ -14,4 +14,14 @@
     const kpv::FixtureAutoregistrar KPV_UNIQUE_NAME(instance){category_id, fixture_factory}; \
     }
 
+// Registers a factory for a geometric series of element counts, factory gets a count as
+// the second argument
+#define REGISTER_FIXTURE_SWEEP(                                                            \
+    category_id, sweep_name, fixture_factory, min_element_count, max_element_count, ratio) \
+    namespace {                                                                            \
+    const kpv::FixtureAutoregistrar KPV_UNIQUE_NAME(instance){                             \
+        category_id, sweep_name, fixture_factory, min_element_count, max_element_count,    \
+        ratio};                                                                            \
+    }
+
 #endif  // KPV_FIXTURE_REGISTER_MACROS_H_
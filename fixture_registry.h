@@ -1,12 +1,14 @@
 #ifndef KPV_FIXTURE_REGISTRY_H_
 #define KPV_FIXTURE_REGISTRY_H_
 
+#include <cmath>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "devices/platform_list.h"
 #include "fixtures/fixture_family.h"
+#include "utils/utils.h"
 
 namespace kpv {
 
@@ -16,11 +18,53 @@ namespace kpv {
 class FixtureRegistry {
 public:
     typedef std::function<std::shared_ptr<FixtureFamily>(const PlatformList&)> FixtureFactory;
+    // Creates a fixture family for a given element count
+    typedef std::function<std::shared_ptr<FixtureFamily>(const PlatformList&, int32_t)>
+        SizedFixtureFactory;
     typedef std::unordered_multimap<std::string, FixtureFactory> FactoryList;
     void Register(const std::string& category_id, FixtureFactory fixture_factory) {
         factories_.emplace(category_id, fixture_factory);
     }
 
+    /*
+    Registers fixture families for a geometric series of element counts, see
+    GetGeometricSeries(). All of them get the same sweep name, so reporters can fit their
+    durations against element count.
+    */
+    void RegisterSweep(
+        const std::string& category_id, const std::string& sweep_name,
+        SizedFixtureFactory fixture_factory, int32_t min_element_count,
+        int32_t max_element_count, double ratio) {
+        for (int32_t element_count :
+             GetGeometricSeries(min_element_count, max_element_count, ratio)) {
+            Register(category_id, [=](const PlatformList& platform_list) {
+                std::shared_ptr<FixtureFamily> fixture_family =
+                    fixture_factory(platform_list, element_count);
+                fixture_family->sweep_name = sweep_name;
+                return fixture_family;
+            });
+        }
+    }
+
+    /*
+    Returns min_value * ratio^i (rounded) for all i while it is not greater than max_value.
+    */
+    static std::vector<int32_t> GetGeometricSeries(
+        int32_t min_value, int32_t max_value, double ratio) {
+        EXCEPTION_ASSERT(min_value > 0 && min_value <= max_value && ratio > 1.0);
+        std::vector<int32_t> result;
+        for (int i = 0;; ++i) {
+            const double value = std::round(min_value * std::pow(ratio, i));
+            if (value > max_value) {
+                break;
+            }
+            if (result.empty() || result.back() != static_cast<int32_t>(value)) {
+                result.push_back(static_cast<int32_t>(value));
+            }
+        }
+        return result;
+    }
+
     // We need a singleton so macros can register factories using this global instance
     static FixtureRegistry& instance() {
         static FixtureRegistry* instance = nullptr;
@@ -15,6 +15,7 @@
 #include "fixture_registry.h"
 #include "fixtures/fixture.h"
 #include "fixtures/fixture_family.h"
+#include "iterators/random_values_iterator.h"
 #include "program_build_failed_exception.h"
 #include "reporters/json_benchmark_reporter.h"
 #include "run_settings.h"
@@ -72,6 +73,11 @@ public:
             return;
         }
 
+        if (settings.random_seed) {
+            SetDefaultRandomSeed(settings.random_seed.value());
+        }
+        BOOST_LOG_TRIVIAL(info) << "Random seed is " << GetDefaultRandomSeed();
+
         JsonBenchmarkReporter reporter(settings.output_file_name);
         PlatformList platform_list(settings.device_config);
         reporter.Initialize(platform_list);
@@ -96,13 +102,18 @@ public:
 
             for (auto& fixture_data : fixture_family->fixtures) {
                 const FixtureId& fixture_id = fixture_data.first;
-                std::shared_ptr<Fixture>& fixture = fixture_data.second;
+                std::shared_ptr<Fixture> fixture;
                 FixtureBenchmark fixture_results;
 
                 BOOST_LOG_TRIVIAL(info)
                     << "Starting run on device \"" << fixture_id.device()->Name() << "\"";
 
                 try {
+                    // Fixture is created just before it runs, so fixtures of a family don't
+                    // occupy memory at once
+                    fixture = fixture_data.second();
+                    EXCEPTION_ASSERT(fixture->Algorithm() == fixture_id.algorithm());
+
                     std::vector<std::string> required_extensions = fixture->GetRequiredExtensions();
                     std::sort(required_extensions.begin(), required_extensions.end());
 
@@ -167,6 +178,7 @@ public:
                         durations.push_back(fixture->Execute(params));
                     }
                     fixture_results.durations = durations;
+                    fixture_results.metrics = fixture->ExecutionMetrics();
                 } catch (ProgramBuildFailedException& e) {
                     BOOST_LOG_TRIVIAL(error)
                         << "Program for fixture \"" << fixture_name
@@ -195,6 +207,9 @@ public:
                 results.benchmark.insert(std::make_pair(fixture_id, fixture_results));
             }
 
+            // Fixtures are destroyed already, so this releases their input data
+            fixture_family->input_data_cache->Clear();
+
             reporter.AddFixtureFamilyResults(results);
 
             BOOST_LOG_TRIVIAL(info)
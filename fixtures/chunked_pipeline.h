@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "boost/compute.hpp"
+#include "utils/duration.h"
+#include "utils/utils.h"
+
+/*
+Runs an element-wise kernel over data split into chunks. Chunks are copied to a device,
+calculated and copied back by three in-order queues, one per stage, and stages of a chunk are
+ordered by events, so copying of one chunk may run concurrently with calculation of another one.
+Kernel should calculate element get_global_id(0) of input and output buffers, chunks are
+launched with a global offset, so buffers are not split and the kernel doesn't change.
+Whether stages really overlap depends on a device (e.g. on separate copy engines) and on host
+memory (pageable memory may be copied synchronously), utilization of stages shows it.
+*/
+class ChunkedPipeline {
+public:
+    explicit ChunkedPipeline(size_t chunk_count) : chunk_count_(chunk_count) {}
+
+    void Initialize(boost::compute::context& context, const boost::compute::device& device) {
+        for (boost::compute::command_queue& queue : queues_) {
+            queue = boost::compute::command_queue(
+                context, device, boost::compute::command_queue::enable_profiling);
+        }
+    }
+
+    // Commands that should precede calculation (e.g. copying of parameters) go to this queue
+    boost::compute::command_queue& compute_queue() { return queues_[kCompute]; }
+
+    /*
+    Copies count elements of input to input_buffer, runs the kernel and copies output_buffer
+    to output chunk by chunk, blocks until all chunks are finished. Kernel arguments should be
+    set before. Returns duration of the whole pipeline, from the start of the first copy
+    to the end of the last one (host wall time if a runtime reports the same timestamp for all
+    commands). Chunks differ in size by at most one element, count should be at least a number
+    of chunks, so none of them is empty.
+    */
+    template <typename In, typename Out>
+    Duration Run(
+        boost::compute::kernel& kernel, const In* input, const boost::compute::buffer& input_buffer,
+        Out* output, const boost::compute::buffer& output_buffer, size_t count) {
+        EXCEPTION_ASSERT(chunk_count_ > 0 && count >= chunk_count_);
+        typedef std::chrono::steady_clock Clock;
+        const Clock::time_point host_start = Clock::now();
+        std::array<std::vector<boost::compute::event>, kStageCount> events;
+        for (size_t chunk = 0; chunk < chunk_count_; ++chunk) {
+            const size_t offset = chunk * count / chunk_count_;
+            const size_t size = (chunk + 1) * count / chunk_count_ - offset;
+            events[kCopyIn].push_back(queues_[kCopyIn].enqueue_write_buffer_async(
+                input_buffer, offset * sizeof(In), size * sizeof(In), input + offset));
+            events[kCompute].push_back(queues_[kCompute].enqueue_1d_range_kernel(
+                kernel, offset, size, 0, boost::compute::wait_list(events[kCopyIn].back())));
+            events[kCopyOut].push_back(queues_[kCopyOut].enqueue_read_buffer_async(
+                output_buffer, offset * sizeof(Out), size * sizeof(Out), output + offset,
+                boost::compute::wait_list(events[kCompute].back())));
+        }
+        for (boost::compute::command_queue& queue : queues_) {
+            queue.flush();
+        }
+        queues_[kCopyOut].finish();
+        const Duration host_duration(Clock::now() - host_start);
+
+        cl_ulong start = std::numeric_limits<cl_ulong>::max();
+        cl_ulong end = 0;
+        std::array<cl_ulong, kStageCount> busy = {};
+        for (size_t stage = 0; stage < kStageCount; ++stage) {
+            // Commands of a queue are executed in order, so their intervals don't intersect
+            for (boost::compute::event& event : events[stage]) {
+                const cl_ulong event_start = event.get_profiling_info<cl_ulong>(
+                    boost::compute::event::profiling_command_start);
+                const cl_ulong event_end = event.get_profiling_info<cl_ulong>(
+                    boost::compute::event::profiling_command_end);
+                start = std::min(start, event_start);
+                end = std::max(end, event_end);
+                busy[stage] += event_end - event_start;
+            }
+        }
+
+        // Utilization is unknown if all timestamps are the same
+        const double total = static_cast<double>(end - start);
+        if (total == 0.0) {
+            utilization_.clear();
+            return host_duration;
+        }
+        utilization_ = {
+            {"Copying input data utilization", busy[kCopyIn] / total},
+            {"Calculating utilization", busy[kCompute] / total},
+            {"Copying output data utilization", busy[kCopyOut] / total}};
+        return Duration(std::chrono::nanoseconds(end - start));
+    }
+
+    // Busy time of every stage relative to the whole pipeline duration, by the last Run()
+    const std::unordered_map<std::string, double>& utilization() const { return utilization_; }
+
+    size_t chunk_count() const { return chunk_count_; }
+
+private:
+    enum Stage { kCopyIn, kCompute, kCopyOut, kStageCount };
+
+    size_t chunk_count_;
+    std::array<boost::compute::command_queue, kStageCount> queues_;
+    std::unordered_map<std::string, double> utilization_;
+};
@@ -2,7 +2,12 @@
 
 #include "fixtures/damped_wave_opencl_fixture.h"
 
+#include <boost/log/trivial.hpp>
+#include <cmath>
+#include <limits>
+
 #include "boost/format.hpp"
+#include "data_verification_failed_exception.h"
 #include "documents/csv_document.h"
 #include "opencl_type_traits.h"
 #include "utils.h"
@@ -20,17 +25,30 @@ typedef struct Parameters
     REAL_T shift;
 } Parameters;
 
+// Number of parameters copied to local memory at once, equal to work group size
+#define PARAMS_TILE_SIZE 64
+
+REAL_T DampedWaveTerm(REAL_T x, REAL_T amplitude, REAL_T damping_ratio,
+    REAL_T angular_frequency, REAL_T phase, REAL_T shift)
+{
+    // TODO why do we need to take absolute value below?
+    REAL_T t = x - shift;
+    return amplitude * exp(-damping_ratio * max( t, (REAL_T)0 )) *
+        cos(angular_frequency * t + phase);
+}
+
+REAL_T DampedWaveTermForParameters(REAL_T x, Parameters param_set)
+{
+    return DampedWaveTerm(x, param_set.amplitude, param_set.damping_ratio,
+        param_set.angular_frequency, param_set.phase, param_set.shift);
+}
+
 REAL_T DampedWave2DImplementation(REAL_T x, __global Parameters* params, int params_count)
 {
     REAL_T result = 0;
-    // TODO copy parameters to faster memory?
     for (int i = 0; i < params_count; ++i)
     {
-        Parameters param_set = params[i];
-        // TODO why do we need to take absolute value below?
-        REAL_T t = x - param_set.shift;
-        result += param_set.amplitude * exp(-param_set.damping_ratio * max( t, (REAL_T)0 )) *
-            cos(param_set.angular_frequency * t + param_set.phase);
+        result += DampedWaveTermForParameters(x, params[i]);
     }
     return result;
 }
@@ -43,8 +61,258 @@ __kernel void DampedWave2D(
     size_t id = get_global_id(0);
     output[id] = DampedWave2DImplementation(input[id], params, params_count);
 }
+
+/*
+    Parameters are copied to local memory by tiles, every work item copies one parameter set,
+    then all of them use the whole tile. Should be started with work group size equal to
+    PARAMS_TILE_SIZE, global size is rounded up, so input size is passed explicitly.
+*/
+__kernel void DampedWave2DLocalMemory(
+    __global REAL_T* input, int input_count,
+    __global Parameters* params, int params_count,
+    __global REAL_T* output)
+{
+    __local Parameters tile[PARAMS_TILE_SIZE];
+    size_t id = get_global_id(0);
+    int local_id = get_local_id(0);
+    REAL_T x = id < input_count ? input[id] : 0;
+    REAL_T result = 0;
+    for (int tile_start = 0; tile_start < params_count; tile_start += PARAMS_TILE_SIZE)
+    {
+        int tile_size = min(PARAMS_TILE_SIZE, params_count - tile_start);
+        // Previous tile must not be used by any work item when it is overwritten
+        barrier(CLK_LOCAL_MEM_FENCE);
+        if (local_id < tile_size)
+        {
+            tile[local_id] = params[tile_start + local_id];
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+        for (int i = 0; i < tile_size; ++i)
+        {
+            result += DampedWaveTermForParameters(x, tile[i]);
+        }
+    }
+    if (id < input_count)
+    {
+        output[id] = result;
+    }
+}
+
+/*
+    Parameters are in constant memory, its size is limited (at least 64 KB).
+*/
+__kernel void DampedWave2DConstantMemory(
+    __global REAL_T* input,
+    __constant Parameters* params, int params_count,
+    __global REAL_T* output)
+{
+    size_t id = get_global_id(0);
+    REAL_T x = input[id];
+    REAL_T result = 0;
+    for (int i = 0; i < params_count; ++i)
+    {
+        result += DampedWaveTermForParameters(x, params[i]);
+    }
+    output[id] = result;
+}
+
+/*
+    Parameters are stored as a structure of arrays: params_count amplitudes,
+    then params_count damping ratios, angular frequencies, phases and shifts.
+*/
+__kernel void DampedWave2DStructureOfArrays(
+    __global REAL_T* input,
+    __global REAL_T* params, int params_count,
+    __global REAL_T* output)
+{
+    __global REAL_T* amplitudes = params;
+    __global REAL_T* damping_ratios = amplitudes + params_count;
+    __global REAL_T* angular_frequencies = damping_ratios + params_count;
+    __global REAL_T* phases = angular_frequencies + params_count;
+    __global REAL_T* shifts = phases + params_count;
+
+    size_t id = get_global_id(0);
+    REAL_T x = input[id];
+    REAL_T result = 0;
+    for (int i = 0; i < params_count; ++i)
+    {
+        result += DampedWaveTerm(x, amplitudes[i], damping_ratios[i], angular_frequencies[i],
+            phases[i], shifts[i]);
+    }
+    output[id] = result;
+}
+
+// Number of sequential inputs processed by one work item of DampedWave2DRecurrence
+#define RECURRENCE_RUN_LENGTH 64
+// exp and cos are calculated directly once per this number of inputs to bound an error
+#define RECURRENCE_ANCHOR_INTERVAL 16
+
+/*
+    Requires sequential input with a constant step. Every work item processes a run of
+    RECURRENCE_RUN_LENGTH inputs. At the first input of every RECURRENCE_ANCHOR_INTERVAL inputs
+    (anchor) exp(-d * t) and cos(w * t + p) are calculated directly, for the next inputs
+    they are advanced by one step:
+    exp(-d * (t + h)) = exp(-d * t) * exp(-d * h)
+    cos(a + w * h) = cos(a) * cos(w * h) - sin(a) * sin(w * h)
+    sin(a + w * h) = sin(a) * cos(w * h) + cos(a) * sin(w * h)
+    step_factors contain (exp(-d * h), cos(w * h), sin(w * h)) for every parameter set.
+    Inputs after an anchor are assumed to be equal to anchor + k * step.
+*/
+__kernel void DampedWave2DRecurrence(
+    __global REAL_T* input, int input_count, REAL_T step,
+    __global Parameters* params, __global REAL_T* step_factors, int params_count,
+    __global REAL_T* output)
+{
+    int run_start = get_global_id(0) * RECURRENCE_RUN_LENGTH;
+    int run_end = min(run_start + RECURRENCE_RUN_LENGTH, input_count);
+    for (int anchor = run_start; anchor < run_end; anchor += RECURRENCE_ANCHOR_INTERVAL)
+    {
+        int count = min(RECURRENCE_ANCHOR_INTERVAL, run_end - anchor);
+        REAL_T results[RECURRENCE_ANCHOR_INTERVAL];
+        for (int k = 0; k < RECURRENCE_ANCHOR_INTERVAL; ++k)
+        {
+            results[k] = 0;
+        }
+        REAL_T x = input[anchor];
+        for (int i = 0; i < params_count; ++i)
+        {
+            Parameters param_set = params[i];
+            REAL_T damping_factor = step_factors[3 * i];
+            REAL_T cos_factor = step_factors[3 * i + 1];
+            REAL_T sin_factor = step_factors[3 * i + 2];
+
+            REAL_T t = x - param_set.shift;
+            REAL_T damping = exp(-param_set.damping_ratio * max( t, (REAL_T)0 ));
+            REAL_T sin_value;
+            REAL_T cos_value =
+                sincos(param_set.angular_frequency * t + param_set.phase, &sin_value);
+            for (int k = 0; k < count; ++k)
+            {
+                results[k] += param_set.amplitude * damping * cos_value;
+
+                REAL_T next_cos_value = cos_value * cos_factor - sin_value * sin_factor;
+                sin_value = sin_value * cos_factor + cos_value * sin_factor;
+                cos_value = next_cos_value;
+                // Damping is constant before the shift, so the recurrence starts after it
+                REAL_T next_t = t + (k + 1) * step;
+                if (next_t > 0)
+                {
+                    damping = (next_t - step > 0) ? damping * damping_factor :
+                        exp(-param_set.damping_ratio * next_t);
+                }
+            }
+        }
+        for (int k = 0; k < count; ++k)
+        {
+            output[anchor + k] = results[k];
+        }
+    }
+}
+
+// Work group size of DampedWave2DParameterBlocks
+#define PARAMS_BLOCK_GROUP_SIZE 64
+// Number of parameter sets processed by one work group of DampedWave2DParameterBlocks
+#define PARAMS_BLOCK_SIZE 256
+
+/*
+    Work is split over (parameter blocks x inputs): dimension 0 is split to work groups of
+    PARAMS_BLOCK_GROUP_SIZE work items, one group per block of PARAMS_BLOCK_SIZE parameter
+    sets, dimension 1 is an input index. Work items of a group sum terms of a block with
+    a stride, their sums are reduced in local memory. Result of a group is stored to
+    partial_results[input index * block count + block index].
+*/
+__kernel void DampedWave2DParameterBlocks(
+    __global REAL_T* input,
+    __global Parameters* params, int params_count,
+    __global REAL_T* partial_results)
+{
+    __local REAL_T local_results[PARAMS_BLOCK_GROUP_SIZE];
+    int local_id = get_local_id(0);
+    int block = get_group_id(0);
+    int block_count = get_num_groups(0);
+    size_t input_id = get_global_id(1);
+    REAL_T x = input[input_id];
+
+    int block_end = min((block + 1) * PARAMS_BLOCK_SIZE, params_count);
+    REAL_T result = 0;
+    for (int i = block * PARAMS_BLOCK_SIZE + local_id; i < block_end;
+        i += PARAMS_BLOCK_GROUP_SIZE)
+    {
+        result += DampedWaveTermForParameters(x, params[i]);
+    }
+
+    local_results[local_id] = result;
+    barrier(CLK_LOCAL_MEM_FENCE);
+    for (int offset = PARAMS_BLOCK_GROUP_SIZE / 2; offset > 0; offset /= 2)
+    {
+        if (local_id < offset)
+        {
+            local_results[local_id] += local_results[local_id + offset];
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+    if (local_id == 0)
+    {
+        partial_results[input_id * block_count + block] = local_results[0];
+    }
+}
+
+/*
+    Second pass of DampedWave2DParameterBlocks, one work item per input sums results of
+    all blocks. Number of blocks is small, so it is done serially.
+*/
+__kernel void DampedWave2DSumParameterBlocks(
+    __global REAL_T* partial_results, int block_count,
+    __global REAL_T* output)
+{
+    size_t id = get_global_id(0);
+    REAL_T result = 0;
+    for (int i = 0; i < block_count; ++i)
+    {
+        result += partial_results[id * block_count + i];
+    }
+    output[id] = result;
+}
 )";
 
+// Should be the same as PARAMS_TILE_SIZE
+constexpr size_t kParamsTileSize = 64;
+// Should be the same as RECURRENCE_RUN_LENGTH
+constexpr size_t kRecurrenceRunLength = 64;
+// Should be the same as PARAMS_BLOCK_GROUP_SIZE and PARAMS_BLOCK_SIZE respectively
+constexpr size_t kParamsBlockGroupSize = 64;
+constexpr size_t kParamsBlockSize = 256;
+// Max error relative to a sum of amplitudes, in epsilons of a type
+constexpr double kMaxNormalizedErrorEpsilons = 1e4;
+
+/*
+Calculates a damped wave with double precision, parameters and input are the same as
+for a device.
+*/
+template <typename T>
+double CalcDampedWaveReference(
+    double x, const std::vector<DampedWaveFixtureParameters<T>>& params) {
+    double result = 0.0;
+    for (const auto& param_set : params) {
+        const double t = x - static_cast<double>(param_set.shift);
+        result += static_cast<double>(param_set.amplitude) *
+                  std::exp(-static_cast<double>(param_set.damping_ratio) * std::max(t, 0.0)) *
+                  std::cos(
+                      static_cast<double>(param_set.angular_frequency) * t +
+                      static_cast<double>(param_set.phase));
+    }
+    return result;
+}
+
+// Distance between value and the next representable value of type T (ULP)
+template <typename T>
+double CalcUlp(double value) {
+    const int exponent =
+        value == 0.0 ? std::numeric_limits<T>::min_exponent - 1
+                     : std::max(std::ilogb(value), std::numeric_limits<T>::min_exponent - 1);
+    return std::ldexp(1.0, exponent - (std::numeric_limits<T>::digits - 1));
+}
+
 const char* kCompilerOptions = "-Werror";
 }  // namespace
 
@@ -52,22 +320,103 @@ template <typename T>
 DampedWaveOpenClFixture<T>::DampedWaveOpenClFixture(
     const std::shared_ptr<OpenClDevice>& device,
     const std::vector<DampedWaveFixtureParameters<T>>& params,
-    const std::shared_ptr<DataSource<T>>& input_data_source, size_t data_size,
-    const std::string& fixture_name)
+    const CachedInputData<T>& input_data, const std::string& fixture_name,
+    DampedWaveAlgorithm algorithm, size_t pipeline_chunk_count)
     : device_(device),
       params_(params),
-      input_data_source_(input_data_source),
-      data_size_(data_size),
-      fixture_name_(fixture_name) {}
+      cached_input_data_(input_data),
+      fixture_name_(fixture_name),
+      algorithm_(algorithm),
+      pipeline_(pipeline_chunk_count) {
+    EXCEPTION_ASSERT(algorithm_ != DampedWaveAlgorithm::kPipelined || pipeline_chunk_count > 0);
+}
 
 template <typename T>
 void DampedWaveOpenClFixture<T>::Initialize() {
-    GenerateData();
+    // Fixture opts in for generation on a device if a data source supports it
+    device_input_generator_ =
+        std::dynamic_pointer_cast<DeviceInputGenerator<T>>(cached_input_data_.data_source());
+    if (device_input_generator_) {
+        // Pipeline copies input from host chunk by chunk, there is nothing to overlap with
+        EXCEPTION_ASSERT(algorithm_ != DampedWaveAlgorithm::kPipelined);
+        GenerateDataOnDevice();
+    } else {
+        GenerateData();
+    }
     std::string compiler_options =
         kCompilerOptions + std::string(" -DREAL_T=") + OpenClTypeTraits<T>::type_name;
-    kernel_ = Utils::BuildKernel(
-        "DampedWave2D", device_->GetContext(), kDampedWaveProgramCode, compiler_options,
-        GetRequiredExtensions());
+    std::string kernel_name;
+    switch (algorithm_) {
+        case DampedWaveAlgorithm::kLocalMemory:
+            kernel_name = "DampedWave2DLocalMemory";
+            break;
+        case DampedWaveAlgorithm::kConstantMemory: {
+            const cl_ulong max_constant_buffer_size =
+                device_->device().get_info<cl_ulong>(CL_DEVICE_MAX_CONSTANT_BUFFER_SIZE);
+            if (params_.size() * sizeof(Parameters) > max_constant_buffer_size) {
+                throw std::runtime_error(
+                    (boost::format("Parameters (%1% bytes) don't fit into constant memory (%2% "
+                                   "bytes)") %
+                     (params_.size() * sizeof(Parameters)) % max_constant_buffer_size)
+                        .str());
+            }
+            kernel_name = "DampedWave2DConstantMemory";
+            break;
+        }
+        case DampedWaveAlgorithm::kStructureOfArrays:
+            GenerateStructureOfArrays();
+            kernel_name = "DampedWave2DStructureOfArrays";
+            break;
+        case DampedWaveAlgorithm::kRecurrence:
+            GenerateStepFactors();
+            kernel_name = "DampedWave2DRecurrence";
+            break;
+        case DampedWaveAlgorithm::kParameterBlocks:
+            kernel_name = "DampedWave2DParameterBlocks";
+            break;
+        case DampedWaveAlgorithm::kPipelined:
+            pipeline_.Initialize(device_->GetContext(), device_->device());
+            kernel_name = "DampedWave2D";
+            break;
+        case DampedWaveAlgorithm::kGlobalMemory:
+        default:
+            kernel_name = "DampedWave2D";
+            break;
+    }
+    boost::compute::program program = Utils::BuildProgram(
+        device_->GetContext(), kDampedWaveProgramCode, compiler_options, GetRequiredExtensions());
+    kernel_ = boost::compute::kernel(program, kernel_name);
+    if (algorithm_ == DampedWaveAlgorithm::kParameterBlocks) {
+        sum_kernel_ = boost::compute::kernel(program, "DampedWave2DSumParameterBlocks");
+    }
+}
+
+template <typename T>
+std::string DampedWaveOpenClFixture<T>::AlgorithmName(DampedWaveAlgorithm algorithm) {
+    switch (algorithm) {
+        case DampedWaveAlgorithm::kLocalMemory:
+            return "parameters in local memory";
+        case DampedWaveAlgorithm::kConstantMemory:
+            return "parameters in constant memory";
+        case DampedWaveAlgorithm::kStructureOfArrays:
+            return "parameters in global memory, structure of arrays";
+        case DampedWaveAlgorithm::kRecurrence:
+            return "recurrence over sequential input";
+        case DampedWaveAlgorithm::kParameterBlocks:
+            return "parameter blocks with work group reduction";
+        case DampedWaveAlgorithm::kPipelined:
+            return "parameters in global memory, pipelined";
+        case DampedWaveAlgorithm::kGlobalMemory:
+        default:
+            return "parameters in global memory";
+    }
+}
+
+template <typename T>
+std::string DampedWaveOpenClFixture<T>::PipelinedAlgorithmName(size_t pipeline_chunk_count) {
+    return (boost::format("%1% by %2% chunks") % AlgorithmName(DampedWaveAlgorithm::kPipelined) %
+            pipeline_chunk_count)
+        .str();
 }
 
 template <typename T>
@@ -78,38 +427,114 @@ std::vector<std::string> DampedWaveOpenClFixture<T>::GetRequiredExtensions() {
 template <typename T>
 std::unordered_map<std::string, Duration> DampedWaveOpenClFixture<T>::Execute(
     const RuntimeParams& params) {
+    if (algorithm_ == DampedWaveAlgorithm::kPipelined) {
+        return ExecutePipelined();
+    }
     boost::compute::context& context = device_->GetContext();
     boost::compute::command_queue& queue = device_->GetQueue();
     std::unordered_map<std::string, boost::compute::event> events;
 
-    // create a vector on the device
-    // TODO do not create it every iteration
-    boost::compute::vector<T> input_device_vector(input_data_.size(), context);
+    const size_t data_size = cached_input_data_.size();
+    boost::compute::buffer input_buffer;
+    if (device_input_generator_) {
+        // Input data is already on the device, it is generated once by Initialize()
+        input_buffer = device_input_buffer_;
+    } else {
+        // create a vector on the device
+        // TODO do not create it every iteration
+        boost::compute::vector<T> input_device_vector(data_size, context);
 
-    // copy data from the host to the device
-    events.insert({"Copying input data",
-                   boost::compute::copy_async(
-                       input_data_.begin(), input_data_.end(), input_device_vector.begin(), queue)
-                       .get_event()});
+        // copy data from the host to the device
+        events.insert({"Copying input data", boost::compute::copy_async(
+                                                 input_data_->begin(), input_data_->end(),
+                                                 input_device_vector.begin(), queue)
+                                                 .get_event()});
+        input_buffer = input_device_vector.get_buffer();
+    }
 
-    boost::compute::vector<Parameters> input_params_vector(params_.size(), context);
-    events.insert({"Copying parameters",
-                   boost::compute::copy_async(
-                       params_.begin(), params_.end(), input_params_vector.begin(), queue)
-                       .get_event()});
+    boost::compute::buffer input_params_buffer;
+    if (algorithm_ == DampedWaveAlgorithm::kStructureOfArrays) {
+        boost::compute::vector<T> input_params_vector(
+            params_structure_of_arrays_.size(), context);
+        events.insert({"Copying parameters",
+                       boost::compute::copy_async(
+                           params_structure_of_arrays_.begin(), params_structure_of_arrays_.end(),
+                           input_params_vector.begin(), queue)
+                           .get_event()});
+        input_params_buffer = input_params_vector.get_buffer();
+    } else {
+        boost::compute::vector<Parameters> input_params_vector(params_.size(), context);
+        events.insert({"Copying parameters",
+                       boost::compute::copy_async(
+                           params_.begin(), params_.end(), input_params_vector.begin(), queue)
+                           .get_event()});
+        input_params_buffer = input_params_vector.get_buffer();
+    }
 
-    boost::compute::vector<T> output_device_vector(input_data_.size(), context);
+    boost::compute::vector<T> output_device_vector(data_size, context);
 
-    kernel_.set_arg(0, input_device_vector);
-    kernel_.set_arg(1, input_params_vector);
     EXCEPTION_ASSERT(params_.size() <= std::numeric_limits<cl_int>::max());
-    kernel_.set_arg(2, static_cast<cl_int>(params_.size()));
-    kernel_.set_arg(3, output_device_vector);
+    EXCEPTION_ASSERT(data_size <= std::numeric_limits<cl_int>::max());
+    if (algorithm_ == DampedWaveAlgorithm::kLocalMemory) {
+        kernel_.set_arg(0, input_buffer);
+        kernel_.set_arg(1, static_cast<cl_int>(data_size));
+        kernel_.set_arg(2, input_params_buffer);
+        kernel_.set_arg(3, static_cast<cl_int>(params_.size()));
+        kernel_.set_arg(4, output_device_vector);
+        // Every work group should be complete, so it can copy tiles of parameters together
+        const size_t global_size =
+            (data_size + kParamsTileSize - 1) / kParamsTileSize * kParamsTileSize;
+        events.insert(
+            {"Calculating",
+             queue.enqueue_1d_range_kernel(kernel_, 0, global_size, kParamsTileSize)});
+    } else if (algorithm_ == DampedWaveAlgorithm::kRecurrence) {
+        boost::compute::vector<T> step_factors_vector(step_factors_.size(), context);
+        events.insert({"Copying step factors",
+                       boost::compute::copy_async(
+                           step_factors_.begin(), step_factors_.end(),
+                           step_factors_vector.begin(), queue)
+                           .get_event()});
+        kernel_.set_arg(0, input_buffer);
+        kernel_.set_arg(1, static_cast<cl_int>(data_size));
+        kernel_.set_arg(2, sizeof(T), &input_step_);
+        kernel_.set_arg(3, input_params_buffer);
+        kernel_.set_arg(4, step_factors_vector);
+        kernel_.set_arg(5, static_cast<cl_int>(params_.size()));
+        kernel_.set_arg(6, output_device_vector);
+        const size_t global_size =
+            (data_size + kRecurrenceRunLength - 1) / kRecurrenceRunLength;
+        events.insert(
+            {"Calculating", queue.enqueue_1d_range_kernel(kernel_, 0, global_size, 0)});
+    } else if (algorithm_ == DampedWaveAlgorithm::kParameterBlocks) {
+        const size_t block_count = (params_.size() + kParamsBlockSize - 1) / kParamsBlockSize;
+        boost::compute::vector<T> partial_results_vector(
+            data_size * block_count, context);
+        kernel_.set_arg(0, input_buffer);
+        kernel_.set_arg(1, input_params_buffer);
+        kernel_.set_arg(2, static_cast<cl_int>(params_.size()));
+        kernel_.set_arg(3, partial_results_vector);
+        const size_t global_size[2] = {block_count * kParamsBlockGroupSize, data_size};
+        const size_t local_size[2] = {kParamsBlockGroupSize, 1};
+        events.insert(
+            {"Calculating",
+             queue.enqueue_nd_range_kernel(kernel_, 2, nullptr, global_size, local_size)});
 
-    events.insert(
-        {"Calculating", queue.enqueue_1d_range_kernel(kernel_, 0, input_data_.size(), 0)});
+        sum_kernel_.set_arg(0, partial_results_vector);
+        sum_kernel_.set_arg(1, static_cast<cl_int>(block_count));
+        sum_kernel_.set_arg(2, output_device_vector);
+        events.insert(
+            {"Summing partial results",
+             queue.enqueue_1d_range_kernel(sum_kernel_, 0, data_size, 0)});
+    } else {
+        kernel_.set_arg(0, input_buffer);
+        kernel_.set_arg(1, input_params_buffer);
+        kernel_.set_arg(2, static_cast<cl_int>(params_.size()));
+        kernel_.set_arg(3, output_device_vector);
+        events.insert(
+            {"Calculating", queue.enqueue_1d_range_kernel(kernel_, 0, data_size, 0)});
+    }
 
-    output_data_.resize(input_data_.size());
+    output_data_.resize(data_size);
     boost::compute::event last_event =
         boost::compute::copy_async(
             output_device_vector.begin(), output_device_vector.end(), output_data_.begin(), queue)
@@ -121,21 +546,166 @@ std::unordered_map<std::string, Duration> DampedWaveOpenClFixture<T>::Execute(
     return Utils::GetOpenCLEventDurations(events);
 }
 
+template <typename T>
+std::unordered_map<std::string, Duration> DampedWaveOpenClFixture<T>::ExecutePipelined() {
+    boost::compute::context& context = device_->GetContext();
+    // Parameters are copied by the calculating queue, so all chunks are calculated after it
+    boost::compute::command_queue& queue = pipeline_.compute_queue();
+    std::unordered_map<std::string, boost::compute::event> events;
+
+    boost::compute::vector<Parameters> input_params_vector(params_.size(), context);
+    events.insert({"Copying parameters",
+                   boost::compute::copy_async(
+                       params_.begin(), params_.end(), input_params_vector.begin(), queue)
+                       .get_event()});
+
+    const size_t data_size = cached_input_data_.size();
+    boost::compute::vector<T> input_device_vector(data_size, context);
+    boost::compute::vector<T> output_device_vector(data_size, context);
+
+    EXCEPTION_ASSERT(params_.size() <= std::numeric_limits<cl_int>::max());
+    kernel_.set_arg(0, input_device_vector);
+    kernel_.set_arg(1, input_params_vector);
+    kernel_.set_arg(2, static_cast<cl_int>(params_.size()));
+    kernel_.set_arg(3, output_device_vector);
+
+    output_data_.resize(data_size);
+    const Duration pipeline_duration = pipeline_.Run(
+        kernel_, input_data_->data(), input_device_vector.get_buffer(), output_data_.data(),
+        output_device_vector.get_buffer(), data_size);
+
+    std::unordered_map<std::string, Duration> durations = Utils::GetOpenCLEventDurations(events);
+    durations.insert({"Pipelined copying and calculating", pipeline_duration});
+    return durations;
+}
+
+template <typename T>
+std::unordered_map<std::string, double> DampedWaveOpenClFixture<T>::ExecutionMetrics() {
+    if (algorithm_ != DampedWaveAlgorithm::kPipelined) {
+        return {};
+    }
+    return pipeline_.utilization();
+}
+
 template <typename T>
 void DampedWaveOpenClFixture<T>::GenerateData() {
-    input_data_.resize(data_size_);
-    std::copy_n(DataSourceAdaptor<T>{input_data_source_}, data_size_, input_data_.begin());
+    if (!input_data_) {
+        input_data_ = cached_input_data_.Get();
+    }
+}
+
+template <typename T>
+void DampedWaveOpenClFixture<T>::GenerateDataOnDevice() {
+    boost::compute::context& context = device_->GetContext();
+    boost::compute::kernel generator_kernel =
+        device_input_generator_->CreateKernel(context, GetRequiredExtensions());
+    device_input_buffer_ = boost::compute::buffer(context, cached_input_data_.size() * sizeof(T));
+    device_input_generator_
+        ->Enqueue(
+            device_->GetQueue(), generator_kernel, device_input_buffer_, cached_input_data_.size())
+        .wait();
+}
+
+template <typename T>
+void DampedWaveOpenClFixture<T>::GenerateStructureOfArrays() {
+    const size_t count = params_.size();
+    params_structure_of_arrays_.resize(5 * count);
+    for (size_t i = 0; i < count; ++i) {
+        params_structure_of_arrays_[i] = params_[i].amplitude;
+        params_structure_of_arrays_[count + i] = params_[i].damping_ratio;
+        params_structure_of_arrays_[2 * count + i] = params_[i].angular_frequency;
+        params_structure_of_arrays_[3 * count + i] = params_[i].phase;
+        params_structure_of_arrays_[4 * count + i] = params_[i].shift;
+    }
+}
+
+template <typename T>
+void DampedWaveOpenClFixture<T>::GenerateStepFactors() {
+    GenerateData();
+    EXCEPTION_ASSERT(input_data_->size() >= 2);
+    if (!std::is_sorted(input_data_->cbegin(), input_data_->cend())) {
+        throw std::runtime_error("Recurrence algorithm requires sequential input data");
+    }
+    // Average step, sequential values of type T are not exactly equidistant
+    const double step =
+        (static_cast<double>(input_data_->back()) - static_cast<double>(input_data_->front())) /
+        static_cast<double>(input_data_->size() - 1);
+    input_step_ = static_cast<T>(step);
+    step_factors_.resize(3 * params_.size());
+    for (size_t i = 0; i < params_.size(); ++i) {
+        const double angle = static_cast<double>(params_[i].angular_frequency) * step;
+        step_factors_[3 * i] =
+            static_cast<T>(std::exp(-static_cast<double>(params_[i].damping_ratio) * step));
+        step_factors_[3 * i + 1] = static_cast<T>(std::cos(angle));
+        step_factors_[3 * i + 2] = static_cast<T>(std::sin(angle));
+    }
+}
+
+template <typename T>
+void DampedWaveOpenClFixture<T>::VerifyResults() {
+    GenerateData();
+    EXCEPTION_ASSERT(output_data_.size() == input_data_->size());
+    double amplitude_sum = 0.0;
+    for (const auto& param_set : params_) {
+        amplitude_sum += std::fabs(static_cast<double>(param_set.amplitude));
+    }
+
+    double max_ulp_error = 0.0;
+    double max_relative_error = 0.0;
+    double max_normalized_error = 0.0;
+    size_t max_normalized_error_index = 0;
+    for (size_t i = 0; i < output_data_.size(); ++i) {
+        const double expected =
+            CalcDampedWaveReference(static_cast<double>((*input_data_)[i]), params_);
+        const double actual = static_cast<double>(output_data_[i]);
+        if (!std::isfinite(actual)) {
+            throw DataVerificationFailedException(
+                (boost::format("Result verification has failed for damped wave fixture. "
+                               "Value %1% is calculated for input value %2%, but %3% is "
+                               "expected.") %
+                 actual % static_cast<double>((*input_data_)[i]) % expected)
+                    .str());
+        }
+        const double error = std::fabs(actual - expected);
+        max_ulp_error = std::max(max_ulp_error, error / CalcUlp<T>(expected));
+        if (expected != 0.0) {
+            max_relative_error = std::max(max_relative_error, error / std::fabs(expected));
+        }
+        const double normalized_error = amplitude_sum > 0.0 ? error / amplitude_sum : error;
+        if (normalized_error > max_normalized_error) {
+            max_normalized_error = normalized_error;
+            max_normalized_error_index = i;
+        }
+    }
+
+    BOOST_LOG_TRIVIAL(info) << "Damped wave, " << Algorithm() << ": max error is "
+                            << max_ulp_error << " ULP, max relative error is "
+                            << max_relative_error << ", max error relative to a sum of "
+                            << "amplitudes is " << max_normalized_error;
+
+    const double max_allowed_error =
+        kMaxNormalizedErrorEpsilons * static_cast<double>(std::numeric_limits<T>::epsilon());
+    if (max_normalized_error > max_allowed_error) {
+        throw DataVerificationFailedException(
+            (boost::format("Result verification has failed for damped wave fixture. "
+                           "Maximum error relative to a sum of amplitudes is %1% (%2% is "
+                           "allowed) for input value %3%.") %
+             max_normalized_error % max_allowed_error %
+             static_cast<double>((*input_data_)[max_normalized_error_index]))
+                .str());
+    }
 }
 
 template <typename T>
 std::vector<std::vector<T>> DampedWaveOpenClFixture<T>::GetResults() {
+    GenerateData();
     // Verify that output data are not empty to check if fixture was executed
     EXCEPTION_ASSERT(!output_data_.empty());
-    EXCEPTION_ASSERT(output_data_.size() == input_data_.size());
-    EXCEPTION_ASSERT(output_data_.size() == data_size_);
+    EXCEPTION_ASSERT(output_data_.size() == input_data_->size());
+    EXCEPTION_ASSERT(output_data_.size() == cached_input_data_.size());
     std::vector<std::vector<T>> result;
     for (size_t index = 0; index < output_data_.size(); ++index) {
-        result.push_back({input_data_.at(index), output_data_.at(index)});
+        result.push_back({input_data_->at(index), output_data_.at(index)});
     }
     return result;
 }
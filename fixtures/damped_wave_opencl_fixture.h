@@ -1,10 +1,12 @@
 #pragma once
 
 #include "boost/compute.hpp"
+#include "chunked_pipeline.h"
 #include "devices/opencl_device.h"
+#include "fixtures/device_input_generator.h"
 #include "fixtures/fixture.h"
 #include "half_precision_fp.h"
-#include "iterators/data_source_adaptor.h"
+#include "fixtures/input_data_cache.h"
 
 // TODO get rid of this - non-portable
 //#pragma pack(push, 1)
@@ -26,14 +28,34 @@ struct DampedWaveFixtureParameters {
 };
 //#pragma pack(pop)
 
+// Where and how parameters are stored for a kernel
+enum class DampedWaveAlgorithm {
+    // Every work item reads parameters from global memory
+    kGlobalMemory,
+    // Work group copies parameters to local memory tile by tile
+    kLocalMemory,
+    // Parameters are in constant memory, works only if they fit into it
+    kConstantMemory,
+    // Parameters are in global memory as a structure of arrays (every field is a separate array)
+    kStructureOfArrays,
+    // Only for sequential input: exp and cos are advanced by recurrences along a run of inputs
+    kRecurrence,
+    // Work is split over inputs and blocks of parameters, partial sums are reduced
+    kParameterBlocks,
+    // As kGlobalMemory, but data is copied and calculated by chunks, so stages of different
+    // chunks overlap. Requires input generated on host
+    kPipelined
+};
+
 /*
 param_set.amplitude * exp(-param_set.damping_ratio * t) *
 cos(param_set.angular_frequency * t + param_set.phase);
 Damped wave fixture
 ( A1 * exp(-D1 * t) * cos( F1 * t + P1 ) ) + ...
-Note that this fixture doesn't verify results since we may get very different
-results in edge values between CPU and OpenCL implementation (it's even
-compiler dependent).
+Results are compared with a double precision reference calculated on host. Errors in ULP
+and relative errors are only reported, because we may get very different results in edge
+values between CPU and OpenCL implementation (it's even compiler dependent), verification
+fails only if an error relative to a sum of amplitudes is too large.
 */
 template <typename T>
 class DampedWaveOpenClFixture : public Fixture {
@@ -41,8 +63,9 @@ public:
     DampedWaveOpenClFixture(
         const std::shared_ptr<OpenClDevice>& device,
         const std::vector<DampedWaveFixtureParameters<T>>& params,
-        const std::shared_ptr<DataSource<T>>& input_data_source, size_t data_size,
-        const std::string& fixture_name);
+        const CachedInputData<T>& input_data, const std::string& fixture_name,
+        DampedWaveAlgorithm algorithm = DampedWaveAlgorithm::kGlobalMemory,
+        size_t pipeline_chunk_count = 0);
 
     void Initialize() override;
 
@@ -50,23 +73,56 @@ public:
 
     std::unordered_map<std::string, Duration> Execute(const RuntimeParams& params) override;
 
+    void VerifyResults() override;
+
     void StoreResults() override;
 
     std::shared_ptr<DeviceInterface> Device() override { return device_; }
 
+    std::unordered_map<std::string, double> ExecutionMetrics() override;
+
+    std::string Algorithm() override {
+        return algorithm_ == DampedWaveAlgorithm::kPipelined
+                   ? PipelinedAlgorithmName(pipeline_.chunk_count())
+                   : AlgorithmName(algorithm_);
+    }
+
+    static std::string AlgorithmName(DampedWaveAlgorithm algorithm);
+
+    // Pipelined variants differ by a number of chunks
+    static std::string PipelinedAlgorithmName(size_t pipeline_chunk_count);
+
 private:
     typedef DampedWaveFixtureParameters<T> Parameters;
 
     const std::shared_ptr<OpenClDevice> device_;
-    std::vector<T> input_data_;
+    // Shared by fixtures of a family. If input is generated on a device, it is generated on
+    // host only when it is needed (e.g. for verification)
+    std::shared_ptr<const std::vector<T>> input_data_;
+    // Set if a data source of input data can generate it on a device
+    std::shared_ptr<DeviceInputGenerator<T>> device_input_generator_;
+    boost::compute::buffer device_input_buffer_;
     std::vector<T> output_data_;
     std::vector<Parameters> params_;
-    std::shared_ptr<DataSource<T>> input_data_source_;
-    size_t data_size_;
+    // Parameters for kStructureOfArrays: all amplitudes, then all damping ratios and so on
+    std::vector<T> params_structure_of_arrays_;
+    // Input step and (exp(-d * step), cos(w * step), sin(w * step)) for every parameter set,
+    // used by kRecurrence
+    T input_step_{};
+    std::vector<T> step_factors_;
+    CachedInputData<T> cached_input_data_;
     boost::compute::kernel kernel_;
+    // Sums partial results of kParameterBlocks
+    boost::compute::kernel sum_kernel_;
     std::string fixture_name_;
+    DampedWaveAlgorithm algorithm_;
+    ChunkedPipeline pipeline_;
 
+    std::unordered_map<std::string, Duration> ExecutePipelined();
     void GenerateData();
+    void GenerateDataOnDevice();
+    void GenerateStructureOfArrays();
+    void GenerateStepFactors();
     /*
     Return results in the following form:
     {
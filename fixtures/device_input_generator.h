@@ -0,0 +1,224 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "boost/compute.hpp"
+#include "boost/math/constants/constants.hpp"
+#include "half_precision_fp.h"
+#include "iterators/data_source.h"
+#include "iterators/random_values_iterator.h"
+#include "utils/philox.h"
+#include "utils/utils.h"
+
+namespace {
+static const char* kDeviceInputGeneratorProgramCode = R"(
+/*
+Generates input values on a device, they are the same as values generated on host by
+DeviceInputGenerator (see it for a description of distributions).
+
+Requires a definition:
+- type of generated values REAL_T
+- type used for calculations COMPUTE_T (double for double values, float otherwise),
+  COMPUTE_DOUBLE is defined if it is double
+- STORE_HALF if REAL_T is half, values are converted with round to nearest even without
+  a need for cl_khr_fp16
+*/
+// Host calculates values without contraction, results should be exactly the same
+#pragma OPENCL FP_CONTRACT OFF
+
+#define DISTRIBUTION_SEQUENTIAL 0
+#define DISTRIBUTION_UNIFORM 1
+#define DISTRIBUTION_NORMAL 2
+
+// The first block of Philox4x32-10 stream, see utils/philox.h
+uint4 Philox4x32(uint4 counter, uint2 key)
+{
+    for (int round = 0; round < 10; ++round)
+    {
+        if (round > 0)
+        {
+            key += (uint2)(0x9E3779B9, 0xBB67AE85);
+        }
+        uint hi0 = mul_hi(0xD2511F53u, counter.x);
+        uint lo0 = 0xD2511F53u * counter.x;
+        uint hi1 = mul_hi(0xCD9E8D57u, counter.z);
+        uint lo1 = 0xCD9E8D57u * counter.z;
+        counter = (uint4)(hi1 ^ counter.y ^ key.x, lo1, hi0 ^ counter.w ^ key.y, lo0);
+    }
+    return counter;
+}
+
+// Uniform value in [0, 1) with all bits of mantissa random
+COMPUTE_T ToUniform(uint x, uint y)
+{
+#ifdef COMPUTE_DOUBLE
+    return (double)((((ulong)x << 32) | y) >> 11) * 0x1.0p-53;
+#else
+    return (float)(x >> 8) * 0x1.0p-24f;
+#endif
+}
+
+/*
+    Value with a given index is a + x * b, where x is the index for sequential values and
+    a random value from a stream of the index for random distributions.
+*/
+__kernel void GenerateInputValues(int distribution, ulong offset, uint2 key, COMPUTE_T a,
+    COMPUTE_T b, __global REAL_T* output)
+{
+    size_t id = get_global_id(0);
+    ulong index = offset + id;
+    COMPUTE_T x;
+    if (distribution == DISTRIBUTION_SEQUENTIAL)
+    {
+        x = (COMPUTE_T)index;
+    }
+    else
+    {
+        uint4 random = Philox4x32((uint4)(0, 0, (uint)index, (uint)(index >> 32)), key);
+        if (distribution == DISTRIBUTION_UNIFORM)
+        {
+            x = ToUniform(random.x, random.y);
+        }
+        else
+        {
+            // Box-Muller transform, u1 is in (0, 1], so its logarithm is finite
+            COMPUTE_T u1 = (COMPUTE_T)1 - ToUniform(random.x, random.y);
+            COMPUTE_T u2 = ToUniform(random.z, random.w);
+            x = sqrt((COMPUTE_T)(-2) * log(u1)) * cospi((COMPUTE_T)2 * u2);
+        }
+    }
+#ifdef STORE_HALF
+    vstore_half_rte(a + x * b, id, output);
+#else
+    output[id] = a + x * b;
+#endif
+}
+)";
+}  // namespace
+
+enum class DeviceInputDistribution {
+    // Values are a + index * b
+    kSequential,
+    // Uniform values in [a; a + b)
+    kUniform,
+    // Normal values with mean a and standard deviation b (Box-Muller transform)
+    kNormal
+};
+
+/*
+Data source which values can be generated by a kernel directly to a device buffer, so fixtures
+with large inputs can skip generation on host and a copy to a device. Host can generate any
+part of the same sequence, e.g. for verification.
+Calculations are done with double precision for double values and single precision otherwise,
+random values are made of the first block of a Philox4x32-10 stream given by a seed and an index
+of a value. Sequential and uniform values are exactly the same on host and device, normal ones
+depend on accuracy of log(), sqrt() and cospi() of a device, so they may differ by a few ULP.
+*/
+template <typename T>
+class DeviceInputGenerator final : public DataSource<T> {
+public:
+    typedef typename std::conditional<std::is_same<T, double>::value, double, float>::type
+        ComputeType;
+
+    DeviceInputGenerator(
+        DeviceInputDistribution distribution, double a, double b,
+        uint64_t seed = GetDefaultRandomSeed())
+        : distribution_(distribution),
+          a_(static_cast<ComputeType>(a)),
+          b_(static_cast<ComputeType>(b)),
+          seed_(seed) {}
+
+    T Get() override { return ValueAt(index_); }
+
+    void Increment() override { ++index_; }
+
+    void Fill(T* dst, size_t n, size_t offset) const override {
+        for (size_t i = 0; i < n; ++i) {
+            dst[i] = ValueAt(offset + i);
+        }
+    }
+
+    // Builds a generation kernel, extensions should contain cl_khr_fp64 for double values
+    boost::compute::kernel CreateKernel(
+        boost::compute::context& context, const std::vector<std::string>& extensions) const {
+        std::string options = std::string("-DREAL_T=") + TypeName();
+        if (std::is_same<T, double>::value) {
+            options += " -DCOMPUTE_T=double -DCOMPUTE_DOUBLE";
+        } else {
+            options += " -DCOMPUTE_T=float";
+        }
+        if (std::is_same<T, half_float::half>::value) {
+            options += " -DSTORE_HALF";
+        }
+        return Utils::BuildKernel(
+            "GenerateInputValues", context, kDeviceInputGeneratorProgramCode, options, extensions);
+    }
+
+    /*
+    Enqueues generation of count values starting from a given offset to a buffer, kernel should be
+    created by CreateKernel() for a context of the queue.
+    */
+    boost::compute::event Enqueue(
+        boost::compute::command_queue& queue, boost::compute::kernel& kernel,
+        const boost::compute::buffer& dst, size_t count, size_t offset = 0) const {
+        EXCEPTION_ASSERT(count > 0);
+        EXCEPTION_ASSERT(dst.size() >= count * sizeof(T));
+        const cl_uint2 key = {static_cast<cl_uint>(seed_), static_cast<cl_uint>(seed_ >> 32)};
+        kernel.set_arg(0, static_cast<cl_int>(distribution_));
+        kernel.set_arg(1, static_cast<cl_ulong>(offset));
+        kernel.set_arg(2, key);
+        kernel.set_arg(3, a_);
+        kernel.set_arg(4, b_);
+        kernel.set_arg(5, dst);
+        return queue.enqueue_1d_range_kernel(kernel, 0, count, 0);
+    }
+
+    uint64_t seed() const { return seed_; }
+
+private:
+    static const char* TypeName() {
+        if (std::is_same<T, double>::value) {
+            return "double";
+        }
+        return std::is_same<T, half_float::half>::value ? "half" : "float";
+    }
+
+    static ComputeType ToUniform(uint32_t x, uint32_t y) {
+        if (std::is_same<ComputeType, double>::value) {
+            return static_cast<ComputeType>(((static_cast<uint64_t>(x) << 32) | y) >> 11) *
+                   static_cast<ComputeType>(1.0 / 9007199254740992.0);
+        }
+        return static_cast<ComputeType>(x >> 8) * static_cast<ComputeType>(1.0 / 16777216.0);
+    }
+
+    T ValueAt(size_t index) const {
+        ComputeType x;
+        if (distribution_ == DeviceInputDistribution::kSequential) {
+            x = static_cast<ComputeType>(index);
+        } else {
+            const Philox4x32::Counter random = Philox4x32::Generate(
+                {0, 0, static_cast<uint32_t>(index), static_cast<uint32_t>(index >> 32)},
+                {static_cast<uint32_t>(seed_), static_cast<uint32_t>(seed_ >> 32)});
+            if (distribution_ == DeviceInputDistribution::kUniform) {
+                x = ToUniform(random[0], random[1]);
+            } else {
+                const ComputeType u1 =
+                    static_cast<ComputeType>(1) - ToUniform(random[0], random[1]);
+                const ComputeType u2 = ToUniform(random[2], random[3]);
+                x = std::sqrt(static_cast<ComputeType>(-2) * std::log(u1)) *
+                    std::cos(boost::math::constants::two_pi<ComputeType>() * u2);
+            }
+        }
+        return static_cast<T>(a_ + x * b_);
+    }
+
+    DeviceInputDistribution distribution_;
+    ComputeType a_;
+    ComputeType b_;
+    uint64_t seed_;
+    size_t index_ = 0;
+};
@@ -19,8 +19,8 @@ public:
     /*
     Optional method to initialize a fixture.
     Called exactly once before running a fixture.
-    Memory allocations should be done here to avoid excess memory consumption since many
-    fixtures may be created at once, but only one of them will be executed at once.
+    Memory allocations should be done here rather than in a constructor, so a fixture that
+    can't run (e.g. because of missing extensions) doesn't allocate anything.
     */
     virtual void Initialize() {}
 
@@ -48,6 +48,14 @@ public:
 
     virtual std::string Algorithm() { return std::string(); }
 
+    /*
+    Optional values that describe execution besides durations (e.g. utilization of pipeline
+    stages), called after the last execution, values are reported as they are.
+    */
+    virtual std::unordered_map<std::string, double> ExecutionMetrics() {
+        return std::unordered_map<std::string, double>();
+    }
+
     /*
     Store results of fixture to a persistent storage (e.g. graphic file).
     Every fixture may provide its own method, but it is optional.
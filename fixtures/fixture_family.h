@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -8,9 +10,59 @@
 #include "boost/optional.hpp"
 #include "fixtures/fixture.h"
 #include "fixtures/fixture_id.h"
+#include "fixtures/input_data_cache.h"
+#include "utils/utils.h"
 
+/*
+Fixtures of a family are stored as factories, a fixture is created just before it is run on
+its device and destroyed right after it, so only one fixture exists at once.
+*/
 struct FixtureFamily {
+    typedef std::function<std::shared_ptr<Fixture>()> FixtureFactory;
+
     std::string name;
-    std::unordered_map<FixtureId, std::shared_ptr<Fixture>> fixtures;
+    std::unordered_map<FixtureId, FixtureFactory> fixtures;
     boost::optional<int32_t> element_count;
+    // Families of a sweep differ only by element count, so they can be compared with each other
+    boost::optional<std::string> sweep_name;
+    // Algorithms of fixtures in order of addition, the first one is a baseline for comparison
+    std::vector<std::string> algorithms;
+    // Input data shared by fixtures, released when the family is finished
+    std::shared_ptr<InputDataCache> input_data_cache = std::make_shared<InputDataCache>();
+
+    /*
+    Adds a fixture for a device, fixtures of one device must have different algorithms.
+    Created fixture should return the same algorithm from Algorithm().
+    */
+    void AddFixture(
+        const std::shared_ptr<DeviceInterface>& device, const std::string& algorithm,
+        const FixtureFactory& create_fixture) {
+        const bool inserted =
+            fixtures.emplace(FixtureId(name, device, algorithm), create_fixture).second;
+        EXCEPTION_ASSERT(inserted);
+        if (std::find(algorithms.cbegin(), algorithms.cend(), algorithm) == algorithms.cend()) {
+            algorithms.push_back(algorithm);
+        }
+    }
+
+    /*
+    Adds a fixture for every algorithm variant, get_algorithm(variant) should return its name
+    and create_fixture(variant) should return a fixture for a given device. Both are copied,
+    fixtures are created later, so they shouldn't capture local variables by reference.
+    Variants should differ only by implementation, using the same input data and
+    verification, so their durations are directly comparable and reporters can rank them.
+    The first variant is a baseline.
+    */
+    template <typename Variant, typename AlgorithmNameGetter, typename FixtureCreator>
+    void AddAlgorithmVariants(
+        const std::shared_ptr<DeviceInterface>& device, const std::vector<Variant>& variants,
+        AlgorithmNameGetter get_algorithm, FixtureCreator create_fixture) {
+        for (const Variant& variant : variants) {
+            AddFixture(
+                device, get_algorithm(variant),
+                [create_fixture, variant]() -> std::shared_ptr<Fixture> {
+                    return create_fixture(variant);
+                });
+        }
+    }
 };
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <typeindex>
+#include <vector>
+
+#include "iterators/data_source.h"
+
+// Identifies input data generated by a data source
+struct InputDataKey {
+    // Describes a data source and its parameters, e.g. "sequential from -10 with step 0.001"
+    std::string description;
+    size_t size = 0;
+    // Seed of random values, 0 for data sources which don't use it
+    uint64_t seed = 0;
+};
+
+/*
+Input data of a fixture family. Fixtures of a family usually differ only by device and
+algorithm, so they get the same input data, which is generated once and shared read-only
+instead of being generated and stored by every fixture.
+Data is reference counted: it is released when the cache is cleared (after the family is
+finished) and no fixture uses it anymore.
+Not thread-safe, fixtures of a family are initialized one by one.
+*/
+class InputDataCache {
+public:
+    /*
+    Returns a value for a given key, creates it with create() if there is no such value yet.
+    Type of a value is a part of the key, so data derived from input data (e.g. expected output)
+    can be stored using the same key.
+    */
+    template <typename V>
+    std::shared_ptr<const V> GetOrCreate(
+        const InputDataKey& key, const std::function<V()>& create) {
+        const EntryKey entry_key(key.description, key.size, key.seed, std::type_index(typeid(V)));
+        auto entry = entries_.find(entry_key);
+        if (entry != entries_.end()) {
+            return std::static_pointer_cast<const V>(entry->second);
+        }
+        auto value = std::make_shared<const V>(create());
+        entries_.emplace(entry_key, value);
+        return value;
+    }
+
+    // Releases references to all values, fixtures that still use them keep them alive
+    void Clear() { entries_.clear(); }
+
+    size_t size() const { return entries_.size(); }
+
+private:
+    typedef std::tuple<std::string, size_t, uint64_t, std::type_index> EntryKey;
+
+    std::map<EntryKey, std::shared_ptr<const void>> entries_;
+};
+
+/*
+Input data of a fixture: values of a data source which are taken from a cache if it is given
+(and generated to it by the first fixture that needs them) or generated by every fixture
+otherwise.
+*/
+template <typename T>
+class CachedInputData {
+public:
+    CachedInputData(
+        const std::shared_ptr<DataSource<T>>& data_source, const InputDataKey& key,
+        const std::shared_ptr<InputDataCache>& cache = nullptr)
+        : data_source_(data_source), key_(key), cache_(cache) {}
+
+    std::shared_ptr<const std::vector<T>> Get() const {
+        return GetOrCreate<std::vector<T>>([this]() {
+            std::vector<T> values(key_.size);
+            FillInParallel(*data_source_, values.data(), values.size());
+            return values;
+        });
+    }
+
+    // Data calculated from input data only, shared between fixtures the same way as input data
+    template <typename V>
+    std::shared_ptr<const V> GetOrCreate(const std::function<V()>& create) const {
+        if (!cache_) {
+            return std::make_shared<const V>(create());
+        }
+        return cache_->GetOrCreate<V>(key_, create);
+    }
+
+    size_t size() const { return key_.size; }
+
+    const std::shared_ptr<DataSource<T>>& data_source() const { return data_source_; }
+
+private:
+    std::shared_ptr<DataSource<T>> data_source_;
+    InputDataKey key_;
+    std::shared_ptr<InputDataCache> cache_;
+};
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "boost/compute.hpp"
+#include "utils/utils.h"
+
+namespace {
+static const char* kKochCurveBoundsReductionProgramCode = R"(
+/*
+Reduces lines to a bounding box and a number of lines that are at least partially outside of
+viewport (rectangle given as (min x, min y, max x, max y)), so results can be verified without
+reading lines.
+
+Requires a definition:
+- floating point type REAL_T
+- REAL_T_2, REAL_T_4 (corresponding vector types with 2 and 4 elements respectively,
+  every REAL_T_4 element is a line from (x; y) to (z; w))
+
+Bounding box is stored as (min x, min y, max x, max y).
+*/
+#define BOUNDS_REDUCTION_GROUP_SIZE 128
+
+REAL_T_4 CombineBounds(REAL_T_4 a, REAL_T_4 b)
+{
+    return (REAL_T_4)(fmin(a.lo, b.lo), fmax(a.hi, b.hi));
+}
+
+/*
+    Every work group reduces a part of lines and stores its result to group_bounds and
+    group_out_of_viewport_counts at index of the group. Lines are processed with a stride
+    equal to global size, so any number of lines can be reduced by a fixed number of groups.
+    If "accumulate" is not zero, results are combined with ones of the previous launch,
+    that way lines may be passed by parts.
+*/
+__kernel void KochBoundsReduceLines(__global REAL_T_4* lines, ulong line_count,
+    float4 viewport, int accumulate,
+    __global REAL_T_4* group_bounds, __global ulong* group_out_of_viewport_counts)
+{
+    __local REAL_T_4 local_bounds[BOUNDS_REDUCTION_GROUP_SIZE];
+    __local ulong local_counts[BOUNDS_REDUCTION_GROUP_SIZE];
+    REAL_T_4 viewport_min = (REAL_T_4)(viewport.x, viewport.y, viewport.x, viewport.y);
+    REAL_T_4 viewport_max = (REAL_T_4)(viewport.z, viewport.w, viewport.z, viewport.w);
+
+    REAL_T_4 bounds = (REAL_T_4)(INFINITY, INFINITY, -INFINITY, -INFINITY);
+    ulong out_of_viewport_count = 0;
+    for (ulong i = get_global_id(0); i < line_count; i += get_global_size(0))
+    {
+        REAL_T_4 line = lines[i];
+        REAL_T_4 line_bounds = (REAL_T_4)(fmin(line.lo, line.hi), fmax(line.lo, line.hi));
+        bounds = CombineBounds(bounds, line_bounds);
+        // Written this way, so NaN coordinates are treated as outside of viewport
+        if (!all((line >= viewport_min) & (line <= viewport_max)))
+        {
+            ++out_of_viewport_count;
+        }
+    }
+
+    int local_id = get_local_id(0);
+    local_bounds[local_id] = bounds;
+    local_counts[local_id] = out_of_viewport_count;
+    barrier(CLK_LOCAL_MEM_FENCE);
+    for (int offset = BOUNDS_REDUCTION_GROUP_SIZE / 2; offset > 0; offset /= 2)
+    {
+        if (local_id < offset)
+        {
+            local_bounds[local_id] =
+                CombineBounds(local_bounds[local_id], local_bounds[local_id + offset]);
+            local_counts[local_id] += local_counts[local_id + offset];
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    if (local_id == 0)
+    {
+        size_t group_id = get_group_id(0);
+        if (accumulate)
+        {
+            group_bounds[group_id] = CombineBounds(group_bounds[group_id], local_bounds[0]);
+            group_out_of_viewport_counts[group_id] += local_counts[0];
+        }
+        else
+        {
+            group_bounds[group_id] = local_bounds[0];
+            group_out_of_viewport_counts[group_id] = local_counts[0];
+        }
+    }
+}
+
+/*
+    Combines results of all work groups of KochBoundsReduceLines into the first element.
+    Number of groups is small, so it is done by one work item.
+*/
+__kernel void KochBoundsReduceGroups(int group_count,
+    __global REAL_T_4* group_bounds, __global ulong* group_out_of_viewport_counts)
+{
+    for (int i = 1; i < group_count; ++i)
+    {
+        group_bounds[0] = CombineBounds(group_bounds[0], group_bounds[i]);
+        group_out_of_viewport_counts[0] += group_out_of_viewport_counts[i];
+    }
+}
+)";
+}  // namespace
+
+/*
+Calculates a bounding box of lines stored on a device and a number of lines that are at least
+partially outside of viewport. Only the result is read back to host.
+Kernels of kKochCurveBoundsReductionProgramCode must be a part of a program passed to
+Initialize().
+T4 is a vector of 4 elements, every element is a line from (x; y) to (z; w).
+*/
+template <typename T4>
+class KochCurveBoundsReduction {
+public:
+    /*
+    Viewport is a rectangle from (0; 0) to (width; height), lines that cross it by less than
+    tolerance are considered to be inside.
+    */
+    KochCurveBoundsReduction(double width, double height, double tolerance = 0.0)
+        : width_(width), height_(height), tolerance_(tolerance) {}
+
+    void Initialize(const boost::compute::context& context, const boost::compute::program& program) {
+        reduce_lines_kernel_ = boost::compute::kernel(program, "KochBoundsReduceLines");
+        reduce_groups_kernel_ = boost::compute::kernel(program, "KochBoundsReduceGroups");
+        group_bounds_ = boost::compute::buffer(context, group_count_ * sizeof(T4));
+        group_out_of_viewport_counts_ =
+            boost::compute::buffer(context, group_count_ * sizeof(cl_ulong));
+        Clear();
+    }
+
+    // Starts a new reduction, the next call of Reduce() overwrites previous results
+    void Clear() {
+        line_count_ = 0;
+        has_pending_result_ = false;
+        bounds_ = T4{};
+        out_of_viewport_count_ = 0;
+    }
+
+    /*
+    Enqueues a reduction of given lines, results are combined with previous calls since Clear().
+    Queue should be in-order, so the reduction starts after commands which calculate lines.
+    */
+    void Reduce(
+        boost::compute::command_queue& queue, const boost::compute::buffer& lines,
+        uint64_t line_count) {
+        if (line_count == 0) {
+            return;
+        }
+        cl_float4 viewport = {
+            static_cast<cl_float>(-tolerance_), static_cast<cl_float>(-tolerance_),
+            static_cast<cl_float>(width_ + tolerance_),
+            static_cast<cl_float>(height_ + tolerance_)};
+        reduce_lines_kernel_.set_arg(0, lines);
+        reduce_lines_kernel_.set_arg(1, static_cast<cl_ulong>(line_count));
+        reduce_lines_kernel_.set_arg(2, viewport);
+        reduce_lines_kernel_.set_arg(3, static_cast<cl_int>(line_count_ > 0));
+        reduce_lines_kernel_.set_arg(4, group_bounds_);
+        reduce_lines_kernel_.set_arg(5, group_out_of_viewport_counts_);
+        queue.enqueue_1d_range_kernel(
+            reduce_lines_kernel_, 0, group_count_ * group_size_, group_size_);
+        line_count_ += line_count;
+        has_pending_result_ = true;
+    }
+
+    // Finishes the reduction and reads results, blocks until they are ready
+    void ReadResult(boost::compute::command_queue& queue) {
+        if (!has_pending_result_) {
+            return;
+        }
+        reduce_groups_kernel_.set_arg(0, static_cast<cl_int>(group_count_));
+        reduce_groups_kernel_.set_arg(1, group_bounds_);
+        reduce_groups_kernel_.set_arg(2, group_out_of_viewport_counts_);
+        queue.enqueue_1d_range_kernel(reduce_groups_kernel_, 0, 1, 1);
+        queue.enqueue_read_buffer(group_bounds_, 0, sizeof(T4), &bounds_);
+        queue.enqueue_read_buffer(
+            group_out_of_viewport_counts_, 0, sizeof(cl_ulong), &out_of_viewport_count_);
+        has_pending_result_ = false;
+    }
+
+    // Results are valid after ReadResult()
+    double min_x() const { return static_cast<double>(bounds_.x); }
+    double min_y() const { return static_cast<double>(bounds_.y); }
+    double max_x() const { return static_cast<double>(bounds_.z); }
+    double max_y() const { return static_cast<double>(bounds_.w); }
+    uint64_t line_count() const { return line_count_; }
+    uint64_t out_of_viewport_count() const { return out_of_viewport_count_; }
+
+private:
+    static const size_t group_count_ = 128;
+    static const size_t group_size_ = 128;
+
+    double width_, height_, tolerance_;
+    boost::compute::kernel reduce_lines_kernel_;
+    boost::compute::kernel reduce_groups_kernel_;
+    boost::compute::buffer group_bounds_;
+    boost::compute::buffer group_out_of_viewport_counts_;
+    bool has_pending_result_ = false;
+    uint64_t line_count_ = 0;
+    T4 bounds_ = {};
+    cl_ulong out_of_viewport_count_ = 0;
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+/*
+Receives lines of Koch curve chunk by chunk when they are generated in streaming mode.
+Chunks are passed in order, lines are valid only during Consume() call.
+T4 is a vector of 4 elements, every element is a line from (x; y) to (z; w).
+*/
+template <typename T4>
+class KochCurveLineSink {
+public:
+    // Called once before the first chunk
+    virtual void Begin(uint64_t /* total_line_count */) {}
+
+    virtual void Consume(const T4* lines, size_t line_count) = 0;
+
+    // Called once after the last chunk
+    virtual void End() {}
+
+    virtual ~KochCurveLineSink() noexcept {}
+};
+
+/*
+Writes lines to a binary file as is, every line takes sizeof(T4) bytes.
+*/
+template <typename T4>
+class KochCurveBinaryFileSink : public KochCurveLineSink<T4> {
+public:
+    explicit KochCurveBinaryFileSink(const std::string& file_name) : file_name_(file_name) {}
+
+    void Begin(uint64_t /* total_line_count */) override {
+        stream_.open(file_name_, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!stream_.is_open()) {
+            throw std::runtime_error("Cannot open file " + file_name_ + " to write lines.");
+        }
+    }
+
+    void Consume(const T4* lines, size_t line_count) override {
+        stream_.write(reinterpret_cast<const char*>(lines), line_count * sizeof(T4));
+        if (!stream_) {
+            throw std::runtime_error("Cannot write lines to file " + file_name_);
+        }
+    }
+
+    void End() override { stream_.close(); }
+
+private:
+    std::string file_name_;
+    std::ofstream stream_;
+};
@@ -1,7 +1,17 @@
 #pragma once
 
+#include <boost/format.hpp>
+#include <cmath>
+#include <limits>
+
 #include "boost/compute.hpp"
+#include "data_verification_failed_exception.h"
+#include "devices/opencl_device.h"
+#include "documents/svg_document.h"
 #include "fixtures/fixture.h"
+#include "fixtures/koch_curve_bounds_reduction.h"
+#include "fixtures/koch_curve_line_sinks.h"
+#include "fixtures/koch_curve_rasterizer.h"
 #include "opencl_type_traits.h"
 #include "program_source_repository.h"
 #include "utils/utils.h"
@@ -66,39 +76,23 @@ void ProcessLine(Line parent_line, __private REAL_T_4* transform_matrices,
     }
 }
 
-/*
-    Process all lines on iteration level "start_iteration", up to iteration level "stop_at_iteration"
-*/
-void KochCurveCalc(int start_iteration, int stop_at_iteration, __global Line* lines_temp_storage)
-{
-    REAL_T_4 transform_matrices[4];
-    BuildTransformationMatrices(transform_matrices);
-    // Calculate total number of intermediate operations needed
-    for (int iter_number = start_iteration; iter_number < stop_at_iteration; ++iter_number)
-    {
-        int line_count = CalcLinesNumberForIteration(iter_number);
-        for (int i = 0; i < line_count; ++i)
-        {
-            size_t parent_line_id = CalcGlobalId((int2)(iter_number, i));
-
-            __global Line* parent_line = lines_temp_storage + parent_line_id;
-            ProcessLine(*parent_line, transform_matrices, lines_temp_storage);
-        }
-    }
-}
-
 ulong MinSpaceNeeded(int stop_at_iteration)
 {
     return CalcLinesNumberForIteration(stop_at_iteration) * sizeof(Line);
 }
 
 /*
-    Build Koch's curve. This kernel iterates all levels up and including "stop_at_iteration".
+    Build one level of Koch's curve: every line on iteration level "parent_iteration" is replaced
+    by 4 lines on the next level.
+    This kernel should be started once per level, from 0 up to (but not including)
+    "stop_at_iteration", with global size equal to number of lines on a parent level.
+    One work item equals to one parent line.
+    Level 0 consists of the only line from (0; 0) to (1; 0), it is stored by the first launch.
 */
-__kernel void KochCurvePrecalculationKernel(int stop_at_iteration,
+__kernel void KochCurvePrecalculationKernel(int parent_iteration, int stop_at_iteration,
     __global void* lines_temp_storage, ulong lines_temp_storage_size)
 {
-    if (get_global_size(0) > 1)
+    if (get_global_size(0) != CalcLinesNumberForIteration(parent_iteration))
     {
         // TODO report error
         return;
@@ -109,10 +103,51 @@ __kernel void KochCurvePrecalculationKernel(int stop_at_iteration,
         // TODO Don't think this check works
         return;
     }
-    int start_iteration = 0;
+    REAL_T_4 transform_matrices[4];
+    BuildTransformationMatrices(transform_matrices);
+
     __global Line* lines_temp_storage_conv = (__global Line*)lines_temp_storage;
-    lines_temp_storage_conv[0] = (Line){.coords = {0, 0, 1, 0}, .ids = {0, 0}};
-    KochCurveCalc(start_iteration, stop_at_iteration, lines_temp_storage_conv);
+    Line parent_line;
+    if (parent_iteration == 0)
+    {
+        parent_line = (Line){.coords = {0, 0, 1, 0}, .ids = {0, 0}};
+        lines_temp_storage_conv[0] = parent_line;
+    }
+    else
+    {
+        size_t parent_line_id = CalcGlobalId((int2)(parent_iteration, get_global_id(0)));
+        parent_line = lines_temp_storage_conv[parent_line_id];
+    }
+    ProcessLine(parent_line, transform_matrices, lines_temp_storage_conv);
+}
+
+/*
+    Calculate a line on iteration level "iteration" by its identifier without temporary storage.
+    Base-4 digits of an identifier (most significant first) are indices of transformation
+    matrices applied on every level. Child line i of a parent line with start S and vector V
+    starts at S + (M0 + ... + M(i-1)) * V and has vector Mi * V.
+*/
+Line CalcLineById(int iteration, ulong id)
+{
+    REAL_T_4 transform_matrices[4];
+    BuildTransformationMatrices(transform_matrices);
+    REAL_T_4 prefix_matrices[4];
+    prefix_matrices[0] = (REAL_T_4)(0);
+    for (int i = 1; i < 4; ++i)
+    {
+        prefix_matrices[i] = prefix_matrices[i - 1] + transform_matrices[i - 1];
+    }
+
+    REAL_T_2 start = (REAL_T_2)(0, 0);
+    REAL_T_2 vector = (REAL_T_2)(1, 0);
+    for (int level = iteration - 1; level >= 0; --level)
+    {
+        int digit = (id >> (2 * level)) & 3;
+        start += MultiplyMatrix2x2AndVector(prefix_matrices[digit], vector);
+        vector = MultiplyMatrix2x2AndVector(transform_matrices[digit], vector);
+    }
+    return (Line){ .coords = MergePointsVectorsToLineVector(start, start + vector),
+        .ids = (int2)(iteration, id) };
 }
 
 REAL_T_4 KochCurveTransformLineToCurve(Line line, REAL_T_4 transform_matrix, REAL_T_2 offset)
@@ -124,13 +159,11 @@ REAL_T_4 KochCurveTransformLineToCurve(Line line, REAL_T_4 transform_matrix, REA
     return (REAL_T_4)(new_start, new_end);
 }
 
-void KochSnowflakeCalc(int stop_at_iteration, __global REAL_T_4* curves, int curves_count,
-    __global Line* lines_temp_storage,
+void KochSnowflakeCalc(Line line, __global REAL_T_4* curves, int curves_count,
     __global REAL_T_4* out)
 {
     size_t id = get_global_id(0);
     size_t result_start_index = id * curves_count;
-    size_t line_index = CalcGlobalId( (int2)(stop_at_iteration, id) );
     for (int i = 0; i < curves_count; ++i)
     {
         REAL_T_4 curve = curves[i];
@@ -140,7 +173,7 @@ void KochSnowflakeCalc(int stop_at_iteration, __global REAL_T_4* curves, int cur
             (REAL_T_4)(curve_vector_norm.x, -curve_vector_norm.y, curve_vector_norm.y, curve_vector_norm.x);
         REAL_T_2 offset = curve.lo;
         out[result_start_index + i] = KochCurveTransformLineToCurve(
-            lines_temp_storage[line_index], transform_matrix, offset
+            line, transform_matrix, offset
         );
     }
 }
@@ -174,17 +207,132 @@ __kernel void KochSnowflakeKernel(int stop_at_iteration,
         return;
     }
     __global Line* lines_temp_storage_conv = (__global Line*)lines_temp_storage;
-    KochSnowflakeCalc(stop_at_iteration, curves, curves_count, lines_temp_storage_conv, out);
+    size_t line_index = CalcGlobalId( (int2)(stop_at_iteration, get_global_id(0)) );
+    KochSnowflakeCalc(lines_temp_storage_conv[line_index], curves, curves_count, out);
 }
-)";
 
-// TODO support for half precision could be added by creating an alternate data type,
-// something like half2 and half4
+/*
+    Same as KochSnowflakeKernel, but every line is calculated directly from its identifier,
+    so neither temporary storage nor precalculation step are needed.
+*/
+__kernel void KochSnowflakeDirectKernel(int stop_at_iteration,
+    __global REAL_T_4* curves, int curves_count,
+    __global REAL_T_4* out )
+{
+    if(get_global_size(0) != CalcLinesNumberForIteration(stop_at_iteration))
+    {
+        // TODO report error
+        return;
+    }
+    KochSnowflakeCalc(CalcLineById(stop_at_iteration, get_global_id(0)), curves, curves_count, out);
+}
+
+/*
+    Streaming variant of KochSnowflakeDirectKernel, calculates only lines with identifiers
+    starting from "first_line_id", one line per work item. Results are stored in "out" in the same
+    format, starting from its beginning, so the last level can be built chunk by chunk.
+*/
+__kernel void KochSnowflakeDirectChunkKernel(int stop_at_iteration, ulong first_line_id,
+    __global REAL_T_4* curves, int curves_count,
+    __global REAL_T_4* out )
+{
+    KochSnowflakeCalc(CalcLineById(stop_at_iteration, first_line_id + get_global_id(0)),
+        curves, curves_count, out);
+}
+
+#define ADAPTIVE_GROUP_SIZE 64
+
+/*
+    One level of adaptive subdivision (level of detail). Every work item takes a line from
+    "front". A line that is shorter than "min_line_length" (or any line on the last level) is
+    final and appended to "out", otherwise its 4 child lines are appended to "next_front".
+    Both outputs stay dense: a work group counts its lines in local memory and reserves space
+    with one atomic operation per output, counters[0] and counters[1] are numbers of lines in
+    "next_front" and "out" respectively.
+    Lines are in curve coordinates, transformation matrices are rotation and scaling only,
+    so children are built the same way as for the base line.
+    Global size is rounded up to ADAPTIVE_GROUP_SIZE, should be started with this local size.
+*/
+__kernel void KochCurveAdaptiveSubdivisionKernel(int is_last_level, float min_line_length,
+    __global REAL_T_4* front, uint front_size, __global REAL_T_4* next_front,
+    __global uint* counters, __global REAL_T_4* out)
+{
+    __local uint local_counts[2];
+    __local uint local_bases[2];
+    if (get_local_id(0) == 0)
+    {
+        local_counts[0] = 0;
+        local_counts[1] = 0;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    size_t id = get_global_id(0);
+    bool is_valid = id < front_size;
+    REAL_T_4 line = is_valid ? front[id] : (REAL_T_4)(0);
+    bool subdivide = is_valid && !is_last_level && length(line.hi - line.lo) >= min_line_length;
+    uint local_index = 0;
+    if (is_valid)
+    {
+        local_index = subdivide ? atomic_add(&local_counts[0], 4) : atomic_inc(&local_counts[1]);
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+    if (get_local_id(0) == 0)
+    {
+        local_bases[0] = atomic_add(&counters[0], local_counts[0]);
+        local_bases[1] = atomic_add(&counters[1], local_counts[1]);
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+    if (!is_valid)
+    {
+        return;
+    }
+
+    if (subdivide)
+    {
+        REAL_T_4 transform_matrices[4];
+        BuildTransformationMatrices(transform_matrices);
+        REAL_T_2 vector = line.hi - line.lo;
+        REAL_T_2 new_start = line.lo;
+        __global REAL_T_4* children = next_front + local_bases[0] + local_index;
+        for (int i = 0; i < 4; ++i)
+        {
+            REAL_T_2 new_end =
+                MultiplyMatrix2x2AndVector(transform_matrices[i], vector) + new_start;
+            children[i] = MergePointsVectorsToLineVector(new_start, new_end);
+            new_start = new_end;
+        }
+    }
+    else
+    {
+        out[local_bases[1] + local_index] = line;
+    }
+}
+)";
 }  // namespace
 
+enum class KochCurveAlgorithm {
+    // All levels are calculated one by one and stored in temporary storage
+    kPrecalculation,
+    // Lines of the last level are calculated directly from their identifiers
+    kDirect,
+    // Same as kDirect, but lines are calculated in fixed-size chunks, so memory usage doesn't
+    // depend on iteration count
+    kStreaming,
+    // Lines are not subdivided when they become shorter than a given length (level of detail),
+    // so number of lines is limited by viewport resolution instead of iteration count
+    kAdaptive
+};
+
+enum class KochCurveOutput {
+    // Lines are read back to host and stored as SVG (streamed to a binary file in streaming mode)
+    kLines,
+    // Lines are rasterized on device, only the image is read back and stored as PNG
+    kImage
+};
+
 /*
 T should be a floating point type (e.g. float, double or half),
-T4 should be a vector of 4 elements of the same type,
+T4 should be a vector of 4 elements of the same type (e.g. cl_float4 or Half4 for half),
 */
 template <typename T, typename T4>
 class KochCurveOpenClFixture : public Fixture {
@@ -193,17 +341,32 @@ public:
         const std::shared_ptr<OpenClDevice>& device, int iterations_count,
         // Vector of lines. Every line becomes a curve that starts at (l.x; l.y) and ends at (l.z;
         // l.w)
-        const std::vector<T4>& curves, double width, double height, const std::string& fixture_name)
+        const std::vector<T4>& curves, double width, double height, const std::string& fixture_name,
+        KochCurveAlgorithm algorithm = KochCurveAlgorithm::kPrecalculation,
+        KochCurveOutput output = KochCurveOutput::kLines,
+        // Lines shorter than this (in pixels) are not subdivided by adaptive algorithm
+        double min_line_length_pix = 0.5)
         : device_(device),
+          algorithm_(algorithm),
+          output_(output),
           iterations_count_(iterations_count),
+          min_line_length_pix_(min_line_length_pix),
           width_(width),
           height_(height),
           curves_(curves),
-          fixture_name_(fixture_name) {
+          fixture_name_(fixture_name),
+          bounds_reduction_(
+              width, height, CalcVerificationTolerance(width, height)),
+          rasterizer_(width, height) {
         static_assert(
             sizeof(T4) == 4 * sizeof(T),
             "Given wrong second template argument to KochCurveOpenClFixture");
-        EXCEPTION_ASSERT(iterations_count >= 1 && iterations_count <= max_iterations_);
+        const bool is_memory_limited = algorithm == KochCurveAlgorithm::kStreaming ||
+                                       algorithm == KochCurveAlgorithm::kAdaptive;
+        EXCEPTION_ASSERT(
+            iterations_count >= 1 &&
+            iterations_count <= (is_memory_limited ? max_streaming_iterations_ : max_iterations_));
+        EXCEPTION_ASSERT(algorithm != KochCurveAlgorithm::kAdaptive || min_line_length_pix > 0);
     }
 
     virtual void Initialize() override {
@@ -215,10 +378,20 @@ public:
              (type_name + "4"))
                 .str();
         std::string source = Utils::CombineStrings(
-            {ProgramSourceRepository::GetKochCurveSource(), kKochCurveProgramCode});
+            {ProgramSourceRepository::GetKochCurveSource(), kKochCurveProgramCode,
+             kKochCurveBoundsReductionProgramCode, kKochCurveRasterizerProgramCode});
 
         program_ = Utils::BuildProgram(
             device_->GetContext(), source, compiler_options, GetRequiredExtensions());
+        if (algorithm_ == KochCurveAlgorithm::kStreaming) {
+            transfer_queue_ = boost::compute::command_queue(
+                device_->GetContext(), device_->device(),
+                boost::compute::command_queue::enable_profiling);
+        }
+        bounds_reduction_.Initialize(device_->GetContext(), program_);
+        if (output_ == KochCurveOutput::kImage) {
+            rasterizer_.Initialize(device_->GetContext(), program_);
+        }
     }
 
     virtual std::vector<std::string> GetRequiredExtensions() override {
@@ -226,32 +399,18 @@ public:
     }
 
     std::unordered_map<std::string, Duration> Execute(const RuntimeParams& params) override {
+        if (algorithm_ == KochCurveAlgorithm::kStreaming) {
+            return ExecuteStreaming();
+        }
+        if (algorithm_ == KochCurveAlgorithm::kAdaptive) {
+            return ExecuteAdaptive();
+        }
         boost::compute::context& context = device_->GetContext();
         boost::compute::command_queue& queue = device_->GetQueue();
         output_data_.clear();
 
-        std::unordered_map<std::string, boost::compute::event> events;
-
-        // TODO find a better way to calculate this value to avoid wasting memory
-        const size_t line_size_in_bytes = 64;
-        static_assert(
-            line_size_in_bytes >= sizeof(T4) + 8,
-            "Capacity allocated for one line is not sufficient");
-        const size_t line_temp_storage_size_in_bytes = CalcTotalLineCount() * line_size_in_bytes;
-        boost::compute::buffer lines_temp_storage(context, line_temp_storage_size_in_bytes);
-        // Precalculation step
-        {
-            boost::compute::kernel kernel(program_, "KochCurvePrecalculationKernel");
-            kernel.set_arg(0, iterations_count_);
+        std::unordered_multimap<std::string, boost::compute::event> events;
 
-            kernel.set_arg(1, lines_temp_storage);
-            kernel.set_arg(2, line_temp_storage_size_in_bytes);
-
-            // TODO implement parallelization
-            events.insert({"Calculating, step 1", queue.enqueue_1d_range_kernel(kernel, 0, 1, 0)});
-        }
-
-        // Final step
         // TODO include data copy in benchmark
         // boost::compute::vector<T4> curves_device_vector( curves_.cbegin(), curves_.cend(), queue
         // );
@@ -260,7 +419,46 @@ public:
         // TODO avoid initialization on release build and use it on debug build
         size_t result_line_count = CalcLineCount() * curves_.size();
         boost::compute::vector<T4> result_device_vector(result_line_count, context);
-        {
+        const unsigned threadsCount = CalcLineCount(iterations_count_);
+        if (algorithm_ == KochCurveAlgorithm::kDirect) {
+            boost::compute::kernel kernel(program_, "KochSnowflakeDirectKernel");
+            kernel.set_arg(0, iterations_count_);
+
+            kernel.set_arg(1, curves_device_vector);
+            kernel.set_arg(2, static_cast<cl_int>(curves_device_vector.size()));
+
+            kernel.set_arg(3, result_device_vector);
+
+            events.insert(
+                {"Calculating", queue.enqueue_1d_range_kernel(kernel, 0, threadsCount, 0)});
+        } else {
+            // TODO find a better way to calculate this value to avoid wasting memory
+            const size_t line_size_in_bytes = 64;
+            static_assert(
+                line_size_in_bytes >= sizeof(T4) + 8,
+                "Capacity allocated for one line is not sufficient");
+            const size_t line_temp_storage_size_in_bytes =
+                CalcTotalLineCount() * line_size_in_bytes;
+            boost::compute::buffer lines_temp_storage(context, line_temp_storage_size_in_bytes);
+            // Precalculation step, one launch per level. Durations of all launches are summed.
+            {
+                boost::compute::kernel kernel(program_, "KochCurvePrecalculationKernel");
+                kernel.set_arg(1, iterations_count_);
+
+                kernel.set_arg(2, lines_temp_storage);
+                kernel.set_arg(3, static_cast<cl_ulong>(line_temp_storage_size_in_bytes));
+
+                for (int parent_iteration = 0; parent_iteration < iterations_count_;
+                     ++parent_iteration) {
+                    kernel.set_arg(0, parent_iteration);
+                    events.insert(
+                        {"Calculating, step 1",
+                         queue.enqueue_1d_range_kernel(
+                             kernel, 0, CalcLineCount(parent_iteration), 0)});
+                }
+            }
+
+            // Final step
             boost::compute::kernel kernel(program_, "KochSnowflakeKernel");
             kernel.set_arg(0, iterations_count_);
 
@@ -272,11 +470,23 @@ public:
 
             kernel.set_arg(5, result_device_vector);
 
-            const unsigned threadsCount = CalcLineCount(iterations_count_);
             events.insert(
                 {"Calculating, step 2", queue.enqueue_1d_range_kernel(kernel, 0, threadsCount, 0)});
         }
 
+        // Results are verified on device, the reduction is not a part of the benchmark
+        bounds_reduction_.Clear();
+        bounds_reduction_.Reduce(queue, result_device_vector.get_buffer(), result_line_count);
+
+        if (output_ == KochCurveOutput::kImage) {
+            rasterizer_.Clear(queue, events);
+            rasterizer_.Rasterize(
+                queue, result_device_vector.get_buffer(), result_line_count, CalcMaxLineLength(),
+                events);
+            rasterizer_.ReadImage(queue, events);
+            return Utils::GetOpenCLEventDurations(events);
+        }
+
         // TODO replace with MappedOpenClBuffer
         boost::compute::event event;
         void* output_data_ptr = queue.enqueue_map_buffer_async(
@@ -298,44 +508,295 @@ public:
     }
 
     virtual void VerifyResults() override {
-        // Verify that all points are within viewport (limited by width and height)
-        auto wrong_point =
-            std::find_if(output_data_.cbegin(), output_data_.cend(), [&](const T4& line) -> bool {
-                return !(IsPointInViewport(line.x, line.y) && IsPointInViewport(line.z, line.w));
-            });
-        if (wrong_point != output_data_.cend()) {
+        // Only bounding box and number of wrong lines are read back
+        bounds_reduction_.ReadResult(device_->GetQueue());
+        if (bounds_reduction_.out_of_viewport_count() > 0) {
             throw DataVerificationFailedException(
                 (boost::format("Result verification has failed for Koch curve fixture. "
-                               "At least one line is outside of viewpoint: %1%.") %
-                 LineToString(*wrong_point))
+                               "%1% lines are outside of viewpoint, bounding box is "
+                               "(%2%; %3%) - (%4%; %5%).") %
+                 bounds_reduction_.out_of_viewport_count() % bounds_reduction_.min_x() %
+                 bounds_reduction_.min_y() % bounds_reduction_.max_x() %
+                 bounds_reduction_.max_y())
                     .str());
         }
     }
 
     std::shared_ptr<DeviceInterface> Device() override { return device_; }
 
+    std::string Algorithm() override {
+        return AlgorithmName(algorithm_, output_, min_line_length_pix_);
+    }
+
+    static std::string AlgorithmName(
+        KochCurveAlgorithm algorithm, KochCurveOutput output, double min_line_length_pix = 0.5) {
+        std::string output_description =
+            output == KochCurveOutput::kImage ? ", rasterized on device" : "";
+        switch (algorithm) {
+            case KochCurveAlgorithm::kDirect:
+                return "direct" + output_description;
+            case KochCurveAlgorithm::kStreaming:
+                return "streaming" + output_description;
+            case KochCurveAlgorithm::kAdaptive:
+                return (boost::format("adaptive, min line length %1% px") % min_line_length_pix)
+                           .str() +
+                       output_description;
+            case KochCurveAlgorithm::kPrecalculation:
+            default:
+                return "precalculation" + output_description;
+        }
+    }
+
     virtual void StoreResults() override {
-        SvgDocument document;
-        document.SetSize(width_, height_);
-        for (const auto& line : output_data_) {
-            document.AddLine(line.x, line.y, line.z, line.w);
+        if (output_ == KochCurveOutput::kImage) {
+            rasterizer_.StorePng(
+                (boost::format("%1%, %2%, %3%.png") % fixture_name_ % device_->Name() %
+                 Algorithm())
+                    .str());
+            return;
         }
         const std::string file_name =
-            (boost::format("%1%, %2%.svg") % fixture_name_ % device_->Name()).str();
-        document.BuildAndWriteToDisk(file_name);
+            (boost::format("%1%, %2%, %3%.%4%") % fixture_name_ % device_->Name() % Algorithm() %
+             (algorithm_ == KochCurveAlgorithm::kStreaming ? "bin" : "svg"))
+                .str();
+        if (algorithm_ == KochCurveAlgorithm::kStreaming) {
+            // Lines are not kept in streaming mode, they are calculated once more and written
+            // to a file chunk by chunk
+            sink_ = std::make_shared<KochCurveBinaryFileSink<T4>>(file_name);
+            ExecuteStreaming();
+            sink_.reset();
+            return;
+        }
+        // Lines of all curves are interleaved in the output, write every curve separately,
+        // so its lines form one continuous polyline. Adaptive algorithm doesn't keep order.
+        SvgDocument document(file_name, width_, height_, true);
+        const size_t curve_count =
+            algorithm_ == KochCurveAlgorithm::kAdaptive ? 1 : curves_.size();
+        for (size_t curve_index = 0; curve_index < curve_count; ++curve_index) {
+            for (size_t i = curve_index; i < output_data_.size(); i += curve_count) {
+                const T4& line = output_data_[i];
+                document.AddLine(line.x, line.y, line.z, line.w);
+            }
+        }
+        document.Close();
     }
 
     virtual ~KochCurveOpenClFixture() {}
 
 private:
     static const int max_iterations_ = 20;
+    static const int max_streaming_iterations_ = 30;
+    // Number of lines per curve calculated at once in streaming mode
+    static const size_t streaming_chunk_line_count_ = 1 << 18;
+    // Should be the same as ADAPTIVE_GROUP_SIZE
+    static const size_t adaptive_group_size_ = 64;
     const std::shared_ptr<OpenClDevice> device_;
+    const KochCurveAlgorithm algorithm_;
+    const KochCurveOutput output_;
     int iterations_count_;
+    double min_line_length_pix_;
     std::vector<T4> output_data_;
     boost::compute::program program_;
     std::vector<T4> curves_;
     double width_, height_;
     const std::string fixture_name_;
+    // Receives lines in streaming mode while results are stored, null during benchmarking
+    std::shared_ptr<KochCurveLineSink<T4>> sink_;
+    KochCurveBoundsReduction<T4> bounds_reduction_;
+    KochCurveRasterizer<T4> rasterizer_;
+    // Queue used to read results in streaming mode, so reading overlaps with calculations
+    boost::compute::command_queue transfer_queue_;
+
+    /*
+    Lines are calculated by chunks on two device buffers in turn. Chunks are verified (and in
+    image output mode rasterized) on device. In lines output mode, while one chunk is calculated,
+    the previous one is read back to host and passed to a sink if there is one.
+    */
+    std::unordered_map<std::string, Duration> ExecuteStreaming() {
+        boost::compute::context& context = device_->GetContext();
+        boost::compute::command_queue& queue = device_->GetQueue();
+        std::unordered_multimap<std::string, boost::compute::event> events;
+
+        boost::compute::vector<T4> curves_device_vector(curves_.size(), context);
+        boost::compute::copy(curves_.cbegin(), curves_.cend(), curves_device_vector.begin(), queue);
+
+        const uint64_t line_count = CalcLineCount();
+        const size_t chunk_line_count =
+            static_cast<size_t>(std::min(line_count, uint64_t{streaming_chunk_line_count_}));
+        const size_t chunk_size = chunk_line_count * curves_.size();
+        boost::compute::vector<T4> device_chunks[2] = {
+            boost::compute::vector<T4>(chunk_size, context),
+            boost::compute::vector<T4>(chunk_size, context)};
+        const bool read_lines = output_ == KochCurveOutput::kLines;
+        std::vector<T4> host_chunks[2];
+        if (read_lines) {
+            host_chunks[0].resize(chunk_size);
+            host_chunks[1].resize(chunk_size);
+        }
+        size_t host_chunk_sizes[2] = {0, 0};
+        boost::compute::event read_events[2];
+
+        boost::compute::kernel kernel(program_, "KochSnowflakeDirectChunkKernel");
+        kernel.set_arg(0, iterations_count_);
+        kernel.set_arg(2, curves_device_vector);
+        kernel.set_arg(3, static_cast<cl_int>(curves_device_vector.size()));
+
+        bounds_reduction_.Clear();
+        if (output_ == KochCurveOutput::kImage) {
+            rasterizer_.Clear(queue, events);
+        }
+        if (sink_) {
+            sink_->Begin(line_count * curves_.size());
+        }
+        size_t chunk_index = 0;
+        for (uint64_t first_line_id = 0; first_line_id < line_count;
+             first_line_id += chunk_line_count, ++chunk_index) {
+            const size_t current = chunk_index % 2;
+            const size_t current_line_count = static_cast<size_t>(
+                std::min<uint64_t>(chunk_line_count, line_count - first_line_id));
+
+            // Buffer may be overwritten only when its previous content is read
+            boost::compute::wait_list calc_wait_list;
+            if (read_lines && chunk_index >= 2) {
+                calc_wait_list.insert(read_events[current]);
+            }
+            kernel.set_arg(1, static_cast<cl_ulong>(first_line_id));
+            kernel.set_arg(4, device_chunks[current]);
+            boost::compute::event calc_event =
+                queue.enqueue_1d_range_kernel(kernel, 0, current_line_count, 0, calc_wait_list);
+            events.insert({"Calculating", calc_event});
+            bounds_reduction_.Reduce(
+                queue, device_chunks[current].get_buffer(), current_line_count * curves_.size());
+            if (output_ == KochCurveOutput::kImage) {
+                rasterizer_.Rasterize(
+                    queue, device_chunks[current].get_buffer(),
+                    current_line_count * curves_.size(), CalcMaxLineLength(), events);
+            }
+            if (!read_lines) {
+                queue.flush();
+                continue;
+            }
+
+            host_chunk_sizes[current] = current_line_count * curves_.size();
+            read_events[current] = transfer_queue_.enqueue_read_buffer_async(
+                device_chunks[current].get_buffer(), 0, host_chunk_sizes[current] * sizeof(T4),
+                host_chunks[current].data(), boost::compute::wait_list(calc_event));
+            events.insert({"Copying output data", read_events[current]});
+            queue.flush();
+            transfer_queue_.flush();
+
+            // Process previous chunk while the current one is calculated
+            if (chunk_index > 0) {
+                const size_t previous = 1 - current;
+                read_events[previous].wait();
+                if (sink_) {
+                    sink_->Consume(host_chunks[previous].data(), host_chunk_sizes[previous]);
+                }
+            }
+        }
+        if (read_lines && chunk_index > 0) {
+            const size_t last = (chunk_index - 1) % 2;
+            read_events[last].wait();
+            if (sink_) {
+                sink_->Consume(host_chunks[last].data(), host_chunk_sizes[last]);
+            }
+        }
+        if (sink_) {
+            sink_->End();
+        }
+        if (output_ == KochCurveOutput::kImage) {
+            rasterizer_.ReadImage(queue, events);
+        }
+
+        return Utils::GetOpenCLEventDurations(events);
+    }
+
+    /*
+    Lines are subdivided level by level. Every level processes a front of lines: final lines
+    are appended to the output, others are replaced by their children in the next front.
+    Size of the next front is read back after every level to start the next one.
+    */
+    std::unordered_map<std::string, Duration> ExecuteAdaptive() {
+        boost::compute::context& context = device_->GetContext();
+        boost::compute::command_queue& queue = device_->GetQueue();
+        output_data_.clear();
+        std::unordered_multimap<std::string, boost::compute::event> events;
+
+        // The first front consists of curves themselves
+        boost::compute::vector<T4> front(curves_.size(), context);
+        boost::compute::copy(curves_.cbegin(), curves_.cend(), front.begin(), queue);
+        boost::compute::vector<T4> next_front(context);
+        boost::compute::vector<T4> result_device_vector(context);
+        boost::compute::vector<cl_uint> counters(2, context);
+        // Number of lines in the next front and in the output
+        cl_uint counters_host[2] = {0, 0};
+        queue.enqueue_write_buffer(
+            counters.get_buffer(), 0, sizeof(counters_host), counters_host);
+
+        boost::compute::kernel kernel(program_, "KochCurveAdaptiveSubdivisionKernel");
+        kernel.set_arg(1, static_cast<cl_float>(min_line_length_pix_));
+        kernel.set_arg(5, counters);
+
+        size_t front_size = curves_.size();
+        for (int level = 0; front_size > 0; ++level) {
+            const bool is_last_level = level == iterations_count_;
+            const size_t max_next_front_size = is_last_level ? 0 : 4 * front_size;
+            const size_t max_line_count = counters_host[1] + front_size;
+            EXCEPTION_ASSERT(
+                std::max(max_next_front_size, max_line_count) <=
+                std::numeric_limits<cl_uint>::max());
+            if (next_front.size() < max_next_front_size) {
+                next_front = boost::compute::vector<T4>(max_next_front_size, context);
+            }
+            if (result_device_vector.size() < max_line_count) {
+                // Previous levels' lines are kept
+                result_device_vector.resize(
+                    std::max(max_line_count, 2 * result_device_vector.size()), queue);
+            }
+
+            kernel.set_arg(0, static_cast<cl_int>(is_last_level));
+            kernel.set_arg(2, front);
+            kernel.set_arg(3, static_cast<cl_uint>(front_size));
+            kernel.set_arg(4, next_front);
+            kernel.set_arg(6, result_device_vector);
+            const size_t global_size =
+                (front_size + adaptive_group_size_ - 1) / adaptive_group_size_ *
+                adaptive_group_size_;
+            events.insert(
+                {"Calculating",
+                 queue.enqueue_1d_range_kernel(kernel, 0, global_size, adaptive_group_size_)});
+
+            boost::compute::event read_event = queue.enqueue_read_buffer_async(
+                counters.get_buffer(), 0, sizeof(counters_host), counters_host);
+            events.insert({"Copying line counts", read_event});
+            read_event.wait();
+
+            front_size = counters_host[0];
+            counters_host[0] = 0;
+            queue.enqueue_write_buffer(
+                counters.get_buffer(), 0, sizeof(cl_uint), &counters_host[0]);
+            std::swap(front, next_front);
+        }
+        const size_t result_line_count = counters_host[1];
+
+        bounds_reduction_.Clear();
+        bounds_reduction_.Reduce(queue, result_device_vector.get_buffer(), result_line_count);
+        if (output_ == KochCurveOutput::kImage) {
+            rasterizer_.Clear(queue, events);
+            rasterizer_.Rasterize(
+                queue, result_device_vector.get_buffer(), result_line_count, CalcMaxLineLength(),
+                events);
+            rasterizer_.ReadImage(queue, events);
+        } else {
+            output_data_.resize(result_line_count);
+            boost::compute::event read_event = queue.enqueue_read_buffer_async(
+                result_device_vector.get_buffer(), 0, result_line_count * sizeof(T4),
+                output_data_.data());
+            events.insert({"Copying output data", read_event});
+            read_event.wait();
+        }
+        return Utils::GetOpenCLEventDurations(events);
+    }
 
     size_t CalcLineCount() { return CalcLineCount(iterations_count_); }
 
@@ -354,9 +815,37 @@ private:
 
     size_t CalcTotalLineCount() { return CalcTotalLineCount(iterations_count_); }
 
-    std::string LineToString(const T4& line) {
-        return (boost::format("(%1%; %2%) - (%3%; %4%)") % line.x % line.y % line.z % line.w).str();
+    /*
+    Every iteration makes lines 3 times shorter. Adaptive algorithm also keeps lines that are
+    shorter than min_line_length_pix_ (but not longer than curves).
+    */
+    double CalcMaxLineLength() {
+        double max_curve_length = 0.0;
+        for (const T4& curve : curves_) {
+            max_curve_length = std::max(
+                max_curve_length,
+                std::hypot(
+                    static_cast<double>(curve.z) - static_cast<double>(curve.x),
+                    static_cast<double>(curve.w) - static_cast<double>(curve.y)));
+        }
+        const double last_level_line_length = max_curve_length / std::pow(3.0, iterations_count_);
+        if (algorithm_ == KochCurveAlgorithm::kAdaptive) {
+            return std::max(
+                last_level_line_length, std::min(max_curve_length, min_line_length_pix_));
+        }
+        return last_level_line_length;
     }
 
-    bool IsPointInViewport(T x, T y) { return x >= 0 && y >= 0 && x <= width_ && y <= height_; }
+    /*
+    Lines that touch viewport borders may slightly cross them because of rounding, by a few
+    ULP of the largest coordinate. Iteration counts are limited for every type, so lines of
+    the last level stay much longer than an ULP and rounding errors don't grow with them.
+    */
+    static double CalcVerificationTolerance(double width, double height) {
+        const double tolerance_ulps = 4.0;
+        const int exponent = std::ilogb(std::max(width, height));
+        const double coordinate_ulp =
+            std::ldexp(1.0, exponent - (std::numeric_limits<T>::digits - 1));
+        return tolerance_ulps * coordinate_ulp;
+    }
 };
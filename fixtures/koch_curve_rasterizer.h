@@ -0,0 +1,404 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "boost/compute.hpp"
+#include "lodepng/source/lodepng.h"
+#include "utils/utils.h"
+
+namespace {
+static const char* kKochCurveRasterizerProgramCode = R"(
+/*
+Rasterizes lines into an 8-bit grayscale image (black lines on white background).
+
+Requires a definition:
+- REAL_T_4 (vector with 4 elements, every element is a line from (x; y) to (z; w)
+  in pixel coordinates)
+
+Image is split into square tiles. Lines are binned first: every line is added to lists
+of all tiles it may touch. Then every tile is drawn by its own work group that accumulates
+coverage in local memory, so atomic operations stay local and every pixel of a global
+coverage buffer is written by one work item only.
+
+Lines are 1 pixel wide and anti-aliased: pixel coverage is 1 - (distance from pixel center to
+the line), so a line touches only pixels which centers are closer than 1 pixel to it.
+Coverage of a line shorter than a pixel is scaled by its length, so a curve made of many short
+lines covers a pixel by its length inside the pixel rather than by a number of lines.
+Coverage is accumulated in fixed point, RASTER_COVERAGE_SCALE is full coverage of a pixel.
+*/
+#define RASTER_TILE_SIZE 16
+#define RASTER_SCAN_GROUP_SIZE 64
+#define RASTER_MAX_COVERAGE 255
+#define RASTER_COVERAGE_SCALE 65536
+
+/*
+    Rectangle of pixels (min x, min y, max x, max y) which may be touched by a line,
+    clipped by the image. If the line is outside of the image, min is greater than max.
+*/
+int4 LinePixelBounds(float4 line, int width_pix, int height_pix)
+{
+    float2 image_max = (float2)(width_pix, height_pix);
+    // Clamp before conversion to integers, so far lines don't overflow
+    float2 lo = clamp(fmin(line.lo, line.hi), (float2)(-2.0f), image_max + 1.0f);
+    float2 hi = clamp(fmax(line.lo, line.hi), (float2)(-2.0f), image_max + 1.0f);
+    int2 pixel_lo = max(convert_int2(floor(lo)) - 1, (int2)(0, 0));
+    int2 pixel_hi = min(convert_int2(floor(hi)) + 1, (int2)(width_pix - 1, height_pix - 1));
+    return (int4)(pixel_lo, pixel_hi);
+}
+
+bool IsEmptyBounds(int4 bounds)
+{
+    return bounds.x > bounds.z || bounds.y > bounds.w;
+}
+
+float DistanceToLine(float2 point, float4 line)
+{
+    float2 vector = line.hi - line.lo;
+    float length_squared = dot(vector, vector);
+    float t = length_squared > 0.0f ?
+        clamp(dot(point - line.lo, vector) / length_squared, 0.0f, 1.0f) : 0.0f;
+    return distance(point, line.lo + t * vector);
+}
+
+/*
+    Counts lines that touch every tile, one work item per line.
+*/
+__kernel void KochRasterCountTiles(__global REAL_T_4* lines, int width_pix, int height_pix,
+    __global uint* tile_counts)
+{
+    float4 line = convert_float4(lines[get_global_id(0)]);
+    int4 bounds = LinePixelBounds(line, width_pix, height_pix);
+    if (IsEmptyBounds(bounds))
+    {
+        return;
+    }
+    int tiles_x = (width_pix + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+    int4 tiles = bounds / RASTER_TILE_SIZE;
+    for (int tile_y = tiles.y; tile_y <= tiles.w; ++tile_y)
+    {
+        for (int tile_x = tiles.x; tile_x <= tiles.z; ++tile_x)
+        {
+            atomic_inc(&tile_counts[tile_y * tiles_x + tile_x]);
+        }
+    }
+}
+
+/*
+    Calculates where line list of every tile starts (exclusive prefix sum of tile counts)
+    and resets counts for the next pass. Should be started as one work group of
+    RASTER_SCAN_GROUP_SIZE work items.
+*/
+__kernel void KochRasterScanTileCounts(__global uint* tile_counts, int tile_count,
+    __global uint* tile_starts, __global uint* tile_ends)
+{
+    __local uint partial_sums[RASTER_SCAN_GROUP_SIZE];
+    int local_id = get_local_id(0);
+    int tiles_per_item = (tile_count + RASTER_SCAN_GROUP_SIZE - 1) / RASTER_SCAN_GROUP_SIZE;
+    int begin = min(local_id * tiles_per_item, tile_count);
+    int end = min(begin + tiles_per_item, tile_count);
+
+    uint sum = 0;
+    for (int i = begin; i < end; ++i)
+    {
+        sum += tile_counts[i];
+    }
+    partial_sums[local_id] = sum;
+    barrier(CLK_LOCAL_MEM_FENCE);
+    if (local_id == 0)
+    {
+        uint offset = 0;
+        for (int i = 0; i < RASTER_SCAN_GROUP_SIZE; ++i)
+        {
+            uint partial_sum = partial_sums[i];
+            partial_sums[i] = offset;
+            offset += partial_sum;
+        }
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    uint offset = partial_sums[local_id];
+    for (int i = begin; i < end; ++i)
+    {
+        tile_starts[i] = offset;
+        // End of a list is moved while the list is filled
+        tile_ends[i] = offset;
+        offset += tile_counts[i];
+        tile_counts[i] = 0;
+    }
+}
+
+/*
+    Adds every line to lists of tiles it touches, one work item per line.
+*/
+__kernel void KochRasterFillTiles(__global REAL_T_4* lines, int width_pix, int height_pix,
+    __global uint* tile_ends, __global uint* tile_lines)
+{
+    float4 line = convert_float4(lines[get_global_id(0)]);
+    int4 bounds = LinePixelBounds(line, width_pix, height_pix);
+    if (IsEmptyBounds(bounds))
+    {
+        return;
+    }
+    int tiles_x = (width_pix + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+    int4 tiles = bounds / RASTER_TILE_SIZE;
+    for (int tile_y = tiles.y; tile_y <= tiles.w; ++tile_y)
+    {
+        for (int tile_x = tiles.x; tile_x <= tiles.z; ++tile_x)
+        {
+            uint index = atomic_inc(&tile_ends[tile_y * tiles_x + tile_x]);
+            tile_lines[index] = get_global_id(0);
+        }
+    }
+}
+
+/*
+    Draws lines of every tile and adds their coverage to the coverage buffer.
+    Should be started with one work group of RASTER_TILE_SIZE x RASTER_TILE_SIZE work items
+    per tile.
+*/
+__kernel void KochRasterDrawTiles(__global REAL_T_4* lines, int width_pix, int height_pix,
+    __global uint* tile_starts, __global uint* tile_ends, __global uint* tile_lines,
+    __global uint* coverage)
+{
+    __local uint tile_coverage[RASTER_TILE_SIZE * RASTER_TILE_SIZE];
+    int local_index = get_local_id(1) * RASTER_TILE_SIZE + get_local_id(0);
+    int tile_index = get_group_id(1) * get_num_groups(0) + get_group_id(0);
+    int2 tile_origin = (int2)(get_group_id(0), get_group_id(1)) * RASTER_TILE_SIZE;
+    int4 tile_bounds = (int4)(tile_origin, tile_origin + RASTER_TILE_SIZE - 1);
+    tile_coverage[local_index] = 0;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    uint end = tile_ends[tile_index];
+    for (uint i = tile_starts[tile_index] + local_index; i < end;
+        i += RASTER_TILE_SIZE * RASTER_TILE_SIZE)
+    {
+        float4 line = convert_float4(lines[tile_lines[i]]);
+        float line_weight = min(distance(line.lo, line.hi), 1.0f) * RASTER_COVERAGE_SCALE;
+        int4 bounds = LinePixelBounds(line, width_pix, height_pix);
+        bounds = (int4)(max(bounds.lo, tile_bounds.lo), min(bounds.hi, tile_bounds.hi));
+        for (int y = bounds.y; y <= bounds.w; ++y)
+        {
+            for (int x = bounds.x; x <= bounds.z; ++x)
+            {
+                float pixel_coverage = 1.0f - DistanceToLine((float2)(x + 0.5f, y + 0.5f), line);
+                if (pixel_coverage > 0.0f)
+                {
+                    atomic_add(
+                        &tile_coverage[(y - tile_origin.y) * RASTER_TILE_SIZE + x - tile_origin.x],
+                        convert_uint_rte(pixel_coverage * line_weight));
+                }
+            }
+        }
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    int2 pixel = tile_origin + (int2)(get_local_id(0), get_local_id(1));
+    if (pixel.x < width_pix && pixel.y < height_pix)
+    {
+        size_t pixel_index = pixel.y * width_pix + pixel.x;
+        coverage[pixel_index] = add_sat(coverage[pixel_index], tile_coverage[local_index]);
+    }
+}
+
+__kernel void KochRasterClear(__global uint* data)
+{
+    data[get_global_id(0)] = 0;
+}
+
+/*
+    Converts coverage to grayscale pixels, one work item per pixel.
+*/
+__kernel void KochRasterBuildImage(__global uint* coverage, __global uchar* image)
+{
+    size_t id = get_global_id(0);
+    uint value = convert_uint_sat_rte(
+        coverage[id] * ((float)RASTER_MAX_COVERAGE / RASTER_COVERAGE_SCALE));
+    image[id] = RASTER_MAX_COVERAGE - min(value, (uint)RASTER_MAX_COVERAGE);
+}
+)";
+}  // namespace
+
+/*
+Rasterizes lines on a device into a grayscale image, so only the image has to be read back
+instead of all lines. Lines may be passed by parts, their coverage is accumulated.
+Kernels of kKochCurveRasterizerProgramCode must be a part of a program passed to Initialize().
+T4 is a vector of 4 elements, every element is a line from (x; y) to (z; w) in pixel coordinates.
+*/
+template <typename T4>
+class KochCurveRasterizer {
+public:
+    // Image covers rectangle from (0; 0) to (width; height), one pixel per unit
+    KochCurveRasterizer(double width, double height)
+        : width_pix_(static_cast<int>(std::ceil(width))),
+          height_pix_(static_cast<int>(std::ceil(height))),
+          tiles_x_((width_pix_ + tile_size_ - 1) / tile_size_),
+          tiles_y_((height_pix_ + tile_size_ - 1) / tile_size_) {
+        EXCEPTION_ASSERT(width_pix_ > 0 && height_pix_ > 0);
+    }
+
+    void Initialize(const boost::compute::context& context, const boost::compute::program& program) {
+        context_ = context;
+        clear_kernel_ = boost::compute::kernel(program, "KochRasterClear");
+        count_kernel_ = boost::compute::kernel(program, "KochRasterCountTiles");
+        scan_kernel_ = boost::compute::kernel(program, "KochRasterScanTileCounts");
+        fill_kernel_ = boost::compute::kernel(program, "KochRasterFillTiles");
+        draw_kernel_ = boost::compute::kernel(program, "KochRasterDrawTiles");
+        build_image_kernel_ = boost::compute::kernel(program, "KochRasterBuildImage");
+
+        const size_t tile_count = tiles_x_ * tiles_y_;
+        const size_t pixel_count = width_pix_ * height_pix_;
+        tile_counts_ = boost::compute::buffer(context, tile_count * sizeof(cl_uint));
+        tile_starts_ = boost::compute::buffer(context, tile_count * sizeof(cl_uint));
+        tile_ends_ = boost::compute::buffer(context, tile_count * sizeof(cl_uint));
+        tile_lines_ = boost::compute::buffer();
+        tile_lines_capacity_ = 0;
+        coverage_ = boost::compute::buffer(context, pixel_count * sizeof(cl_uint));
+        image_device_ = boost::compute::buffer(context, pixel_count * sizeof(cl_uchar));
+        image_.resize(pixel_count);
+    }
+
+    // Starts a new image
+    void Clear(
+        boost::compute::command_queue& queue,
+        std::unordered_multimap<std::string, boost::compute::event>& events) {
+        ClearBuffer(queue, tile_counts_, tiles_x_ * tiles_y_, events);
+        ClearBuffer(queue, coverage_, image_.size(), events);
+    }
+
+    /*
+    Draws lines from a device buffer. All kernels are enqueued to an in-order queue,
+    so they are started after previous commands which calculate lines.
+    Max line length is used to estimate a capacity of tile lists.
+    */
+    void Rasterize(
+        boost::compute::command_queue& queue, const boost::compute::buffer& lines,
+        size_t line_count, double max_line_length,
+        std::unordered_multimap<std::string, boost::compute::event>& events) {
+        if (line_count == 0) {
+            return;
+        }
+        ReserveTileLines(line_count, max_line_length);
+
+        count_kernel_.set_arg(0, lines);
+        count_kernel_.set_arg(1, static_cast<cl_int>(width_pix_));
+        count_kernel_.set_arg(2, static_cast<cl_int>(height_pix_));
+        count_kernel_.set_arg(3, tile_counts_);
+        events.insert(
+            {"Rasterizing", queue.enqueue_1d_range_kernel(count_kernel_, 0, line_count, 0)});
+
+        scan_kernel_.set_arg(0, tile_counts_);
+        scan_kernel_.set_arg(1, static_cast<cl_int>(tiles_x_ * tiles_y_));
+        scan_kernel_.set_arg(2, tile_starts_);
+        scan_kernel_.set_arg(3, tile_ends_);
+        events.insert(
+            {"Rasterizing",
+             queue.enqueue_1d_range_kernel(scan_kernel_, 0, scan_group_size_, scan_group_size_)});
+
+        fill_kernel_.set_arg(0, lines);
+        fill_kernel_.set_arg(1, static_cast<cl_int>(width_pix_));
+        fill_kernel_.set_arg(2, static_cast<cl_int>(height_pix_));
+        fill_kernel_.set_arg(3, tile_ends_);
+        fill_kernel_.set_arg(4, tile_lines_);
+        events.insert(
+            {"Rasterizing", queue.enqueue_1d_range_kernel(fill_kernel_, 0, line_count, 0)});
+
+        draw_kernel_.set_arg(0, lines);
+        draw_kernel_.set_arg(1, static_cast<cl_int>(width_pix_));
+        draw_kernel_.set_arg(2, static_cast<cl_int>(height_pix_));
+        draw_kernel_.set_arg(3, tile_starts_);
+        draw_kernel_.set_arg(4, tile_ends_);
+        draw_kernel_.set_arg(5, tile_lines_);
+        draw_kernel_.set_arg(6, coverage_);
+        const size_t global_size[2] = {tiles_x_ * tile_size_, tiles_y_ * tile_size_};
+        const size_t local_size[2] = {tile_size_, tile_size_};
+        events.insert(
+            {"Rasterizing",
+             queue.enqueue_nd_range_kernel(draw_kernel_, 2, nullptr, global_size, local_size)});
+    }
+
+    // Converts accumulated coverage to an image and reads it to host
+    void ReadImage(
+        boost::compute::command_queue& queue,
+        std::unordered_multimap<std::string, boost::compute::event>& events) {
+        build_image_kernel_.set_arg(0, coverage_);
+        build_image_kernel_.set_arg(1, image_device_);
+        events.insert(
+            {"Rasterizing",
+             queue.enqueue_1d_range_kernel(build_image_kernel_, 0, image_.size(), 0)});
+        boost::compute::event last_event =
+            queue.enqueue_read_buffer_async(image_device_, 0, image_.size(), image_.data());
+        events.insert({"Copying image", last_event});
+        last_event.wait();
+    }
+
+    void StorePng(const std::string& file_name) const {
+        unsigned error = lodepng::encode(file_name, image_, width_pix_, height_pix_, LCT_GREY, 8);
+        if (error) {
+            throw std::runtime_error(
+                "Error when building PNG " + file_name + ": " + lodepng_error_text(error));
+        }
+    }
+
+    const std::vector<unsigned char>& image() const { return image_; }
+    int width_pix() const { return width_pix_; }
+    int height_pix() const { return height_pix_; }
+
+private:
+    static const size_t tile_size_ = 16;
+    static const size_t scan_group_size_ = 64;
+
+    /*
+    Every line touches tiles of its bounding box widened by one pixel, that gives an upper bound
+    for the total length of tile lists.
+    */
+    void ReserveTileLines(
+        size_t line_count, double max_line_length) {
+        const size_t max_span_pix = static_cast<size_t>(std::ceil(max_line_length)) + 4;
+        const size_t tiles_per_line = std::min(max_span_pix / tile_size_ + 2, tiles_x_) *
+                                      std::min(max_span_pix / tile_size_ + 2, tiles_y_);
+        const size_t required_size = line_count * tiles_per_line;
+        // Indices of tile lists are 32 bit
+        EXCEPTION_ASSERT(required_size <= std::numeric_limits<cl_uint>::max());
+        if (tile_lines_capacity_ < required_size) {
+            tile_lines_ = boost::compute::buffer(context_, required_size * sizeof(cl_uint));
+            tile_lines_capacity_ = required_size;
+        }
+    }
+
+    void ClearBuffer(
+        boost::compute::command_queue& queue, const boost::compute::buffer& buffer, size_t size,
+        std::unordered_multimap<std::string, boost::compute::event>& events) {
+        clear_kernel_.set_arg(0, buffer);
+        events.insert({"Rasterizing", queue.enqueue_1d_range_kernel(clear_kernel_, 0, size, 0)});
+    }
+
+    const int width_pix_, height_pix_;
+    const size_t tiles_x_, tiles_y_;
+
+    boost::compute::context context_;
+    boost::compute::kernel clear_kernel_;
+    boost::compute::kernel count_kernel_;
+    boost::compute::kernel scan_kernel_;
+    boost::compute::kernel fill_kernel_;
+    boost::compute::kernel draw_kernel_;
+    boost::compute::kernel build_image_kernel_;
+
+    // Buffers of cl_uint, except image_device_ which contains cl_uchar pixels
+    boost::compute::buffer tile_counts_;
+    // Line list of tile i is in tile_lines_ from tile_starts_[i] to tile_ends_[i]
+    boost::compute::buffer tile_starts_;
+    boost::compute::buffer tile_ends_;
+    boost::compute::buffer tile_lines_;
+    size_t tile_lines_capacity_ = 0;
+    boost::compute::buffer coverage_;
+    boost::compute::buffer image_device_;
+
+    std::vector<unsigned char> image_;
+};
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "boost/compute.hpp"
+#include "boost/format.hpp"
+#include "devices/opencl_device.h"
+#include "fixtures/fixture.h"
+#include "utils/duration.h"
+#include "utils/utils.h"
+
+namespace {
+const char* kEmptyKernelCode = R"(
+__kernel void Empty()
+{
+}
+)";
+}  // namespace
+
+enum class LaunchOverheadCase {
+    // Host time of a single enqueue of an empty kernel, the kernel is waited for afterwards
+    kEmptyKernel,
+    // Same as kEmptyKernel, but all arguments of a kernel are set by set_arg() before enqueue
+    kKernelArguments,
+    // A number of empty kernels enqueued without waits, host time includes waiting for all of them
+    kBackToBack,
+    // Host time from enqueue of an empty kernel until its event.wait() returns
+    kRoundTrip
+};
+
+/*
+Measures fixed costs of a kernel launch that every fixture pays, kernels have a single work item
+and do nothing. Steps are intervals between profiling timestamps of commands (summed over
+all launches of an iteration): queued -> submitted to a device -> started -> ended, and host
+wall time of an iteration. Runtimes may report the same timestamps for such kernels, host
+wall time is never zero. Host wall time of the fastest iteration is also reported as metrics,
+in total and per launch.
+Batches of work which take less than these costs are dominated by launch overhead.
+*/
+class LaunchOverheadOpenClFixture : public Fixture {
+public:
+    // count is a number of kernel arguments for kKernelArguments and a number of launches
+    // for kBackToBack, it is ignored by other cases
+    LaunchOverheadOpenClFixture(
+        const std::shared_ptr<OpenClDevice>& device, LaunchOverheadCase launch_case,
+        size_t count = 1)
+        : device_(device), launch_case_(launch_case), count_(count) {
+        EXCEPTION_ASSERT(count_ > 0);
+    }
+
+    void Initialize() override {
+        if (launch_case_ == LaunchOverheadCase::kKernelArguments) {
+            kernel_ = Utils::BuildKernel(
+                "Arguments", device_->GetContext(), GetArgumentsKernelCode(count_));
+        } else {
+            kernel_ = Utils::BuildKernel("Empty", device_->GetContext(), kEmptyKernelCode);
+        }
+    }
+
+    std::vector<std::string> GetRequiredExtensions() override {
+        return std::vector<std::string>();  // This fixture doesn't require any special extensions
+    }
+
+    std::unordered_map<std::string, Duration> Execute(const RuntimeParams& /* params */) override {
+        typedef std::chrono::steady_clock Clock;
+        boost::compute::command_queue& queue = device_->GetQueue();
+        std::vector<boost::compute::event> events;
+        Clock::time_point start = Clock::now();
+        Duration host_duration;
+        switch (launch_case_) {
+            case LaunchOverheadCase::kKernelArguments:
+                for (size_t i = 0; i < count_; ++i) {
+                    kernel_.set_arg(i, static_cast<cl_int>(i));
+                }
+                events.push_back(queue.enqueue_1d_range_kernel(kernel_, 0, 1, 0));
+                host_duration = Duration(Clock::now() - start);
+                queue.finish();
+                break;
+            case LaunchOverheadCase::kBackToBack:
+                for (size_t i = 0; i < count_; ++i) {
+                    events.push_back(queue.enqueue_1d_range_kernel(kernel_, 0, 1, 0));
+                }
+                queue.finish();
+                host_duration = Duration(Clock::now() - start);
+                break;
+            case LaunchOverheadCase::kRoundTrip:
+                events.push_back(queue.enqueue_1d_range_kernel(kernel_, 0, 1, 0));
+                events.back().wait();
+                host_duration = Duration(Clock::now() - start);
+                break;
+            case LaunchOverheadCase::kEmptyKernel:
+            default:
+                events.push_back(queue.enqueue_1d_range_kernel(kernel_, 0, 1, 0));
+                host_duration = Duration(Clock::now() - start);
+                queue.finish();
+                break;
+        }
+        if (min_host_duration_ == Duration() || host_duration < min_host_duration_) {
+            min_host_duration_ = host_duration;
+        }
+
+        std::unordered_map<std::string, Duration> durations = {{"Host wall time", host_duration}};
+        for (const boost::compute::event& event : events) {
+            durations["Queued to submitted"] += GetProfilingInterval(
+                event, boost::compute::event::profiling_command_queued,
+                boost::compute::event::profiling_command_submit);
+            durations["Submitted to started"] += GetProfilingInterval(
+                event, boost::compute::event::profiling_command_submit,
+                boost::compute::event::profiling_command_start);
+            durations["Started to ended"] += GetProfilingInterval(
+                event, boost::compute::event::profiling_command_start,
+                boost::compute::event::profiling_command_end);
+        }
+        return durations;
+    }
+
+    std::unordered_map<std::string, double> ExecutionMetrics() override {
+        if (min_host_duration_ == Duration()) {
+            return {};
+        }
+        const double microseconds = min_host_duration_.AsSeconds() * 1e6;
+        return {{"Host wall time, us", microseconds},
+                {"Host wall time per launch, us", microseconds / GetLaunchCount()}};
+    }
+
+    std::shared_ptr<DeviceInterface> Device() override { return device_; }
+
+    std::string Algorithm() override { return AlgorithmName(launch_case_, count_); }
+
+    static std::string AlgorithmName(LaunchOverheadCase launch_case, size_t count = 1) {
+        switch (launch_case) {
+            case LaunchOverheadCase::kKernelArguments:
+                return (boost::format("empty kernel with %1% arguments set by set_arg") % count)
+                    .str();
+            case LaunchOverheadCase::kBackToBack:
+                return (boost::format("%1% back-to-back launches without waits") % count).str();
+            case LaunchOverheadCase::kRoundTrip:
+                return "enqueue and wait round trip";
+            case LaunchOverheadCase::kEmptyKernel:
+            default:
+                return "empty kernel launch";
+        }
+    }
+
+private:
+    // Kernel with a given number of int arguments which it doesn't use
+    static std::string GetArgumentsKernelCode(size_t argument_count) {
+        std::vector<std::string> arguments;
+        for (size_t i = 0; i < argument_count; ++i) {
+            arguments.push_back((boost::format("int a%1%") % i).str());
+        }
+        return (boost::format("__kernel void Arguments(%1%)\n{\n}\n") %
+                Utils::CombineStrings(arguments, ", "))
+            .str();
+    }
+
+    // Interval between two profiling timestamps, zero if a runtime reports them out of order
+    static Duration GetProfilingInterval(
+        const boost::compute::event& event, cl_profiling_info from, cl_profiling_info to) {
+        const cl_ulong from_ns = event.get_profiling_info<cl_ulong>(from);
+        const cl_ulong to_ns = event.get_profiling_info<cl_ulong>(to);
+        return Duration(std::chrono::nanoseconds(std::max(from_ns, to_ns) - from_ns));
+    }
+
+    size_t GetLaunchCount() const {
+        return launch_case_ == LaunchOverheadCase::kBackToBack ? count_ : 1;
+    }
+
+    const std::shared_ptr<OpenClDevice> device_;
+    const LaunchOverheadCase launch_case_;
+    const size_t count_;
+    boost::compute::kernel kernel_;
+    // Host wall time of the fastest iteration
+    Duration min_host_duration_;
+};
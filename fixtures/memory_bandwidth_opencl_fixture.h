@@ -0,0 +1,277 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "boost/compute.hpp"
+#include "boost/format.hpp"
+#include "data_verification_failed_exception.h"
+#include "devices/opencl_device.h"
+#include "fixtures/fixture.h"
+#include "utils/duration.h"
+#include "utils/utils.h"
+
+namespace {
+// Value of every element of a filled buffer
+constexpr cl_uint kFillPattern = 0xA5A5A5A5u;
+}  // namespace
+
+enum class TransferDirection { kHostToDevice, kDeviceToHost, kDeviceToDevice };
+
+// How data is transferred, host methods are for kHostToDevice and kDeviceToHost only
+enum class TransferMethod {
+    // Host memory is allocated by std::vector, a runtime may copy it through a staging buffer
+    kPageable,
+    // Host memory is a mapped buffer allocated by a runtime (CL_MEM_ALLOC_HOST_PTR), usually it
+    // is page-locked, so it can be copied by DMA directly
+    kPinned,
+    // Device buffer is mapped to host memory, copied by host and unmapped
+    kMapUnmap,
+    // Device to device only, clEnqueueCopyBuffer
+    kCopyBuffer,
+    // Device to device only, destination is filled with a pattern by clEnqueueFillBuffer,
+    // there is no source, so only writes are measured
+    kFillBuffer
+};
+
+/*
+Measures raw transfer performance: one transfer of a given number of bytes per iteration.
+Bandwidth (in 10^9 bytes per second) and latency are calculated from the fastest iteration
+and reported as metrics, they are a reference for fixtures which may be bandwidth bound.
+A copy between device buffers reads and writes every byte, bandwidth counts it once.
+*/
+class MemoryBandwidthOpenClFixture : public Fixture {
+public:
+    MemoryBandwidthOpenClFixture(
+        const std::shared_ptr<OpenClDevice>& device, size_t size, TransferDirection direction,
+        TransferMethod method)
+        : device_(device), size_(size), direction_(direction), method_(method) {
+        EXCEPTION_ASSERT(size_ > 0 && size_ % sizeof(cl_uint) == 0);
+        const std::vector<TransferMethod> methods = GetTransferMethods(direction_);
+        EXCEPTION_ASSERT(std::find(methods.cbegin(), methods.cend(), method_) != methods.cend());
+    }
+
+    void Initialize() override {
+        const cl_ulong max_alloc_size = device_->device().max_memory_alloc_size();
+        if (size_ > max_alloc_size) {
+            throw std::runtime_error(
+                (boost::format("Buffer (%1% bytes) is larger than max allocation size of "
+                               "the device (%2% bytes)") %
+                 size_ % max_alloc_size)
+                    .str());
+        }
+        boost::compute::context& context = device_->GetContext();
+        boost::compute::command_queue& queue = device_->GetQueue();
+        device_buffer_ = boost::compute::buffer(context, size_);
+
+        // Every element is its index, so misplaced data is detected by verification
+        std::vector<cl_uint> pattern(size_ / sizeof(cl_uint));
+        std::iota(pattern.begin(), pattern.end(), 0);
+        if (direction_ == TransferDirection::kDeviceToDevice) {
+            source_buffer_ = boost::compute::buffer(context, size_);
+            queue.enqueue_write_buffer(source_buffer_, 0, size_, pattern.data());
+            return;
+        }
+
+        if (method_ == TransferMethod::kPinned) {
+            // Buffer stays mapped until the fixture is destroyed, its host memory is used as
+            // a source or a destination of transfers
+            pinned_buffer_ = boost::compute::buffer(
+                context, size_, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR);
+            host_ptr_ = static_cast<cl_uint*>(
+                queue.enqueue_map_buffer(pinned_buffer_, CL_MAP_READ | CL_MAP_WRITE, 0, size_));
+        } else {
+            host_data_.resize(pattern.size());
+            host_ptr_ = host_data_.data();
+        }
+        if (direction_ == TransferDirection::kHostToDevice) {
+            std::copy(pattern.cbegin(), pattern.cend(), host_ptr_);
+        } else {
+            queue.enqueue_write_buffer(device_buffer_, 0, size_, pattern.data());
+            std::fill_n(host_ptr_, pattern.size(), 0);
+        }
+    }
+
+    std::vector<std::string> GetRequiredExtensions() override {
+        return std::vector<std::string>();  // This fixture doesn't require any special extensions
+    }
+
+    std::unordered_map<std::string, Duration> Execute(const RuntimeParams& params) override {
+        std::unordered_map<std::string, Duration> durations = method_ == TransferMethod::kMapUnmap
+                                                                  ? ExecuteMapUnmap()
+                                                                  : ExecuteEnqueued();
+        const Duration total = std::accumulate(
+            durations.begin(), durations.end(), Duration(),
+            [](Duration acc, const std::pair<std::string, Duration>& d) {
+                return acc + d.second;
+            });
+        if (min_duration_ == Duration() || total < min_duration_) {
+            min_duration_ = total;
+        }
+        return durations;
+    }
+
+    void VerifyResults() override {
+        const size_t count = size_ / sizeof(cl_uint);
+        std::vector<cl_uint> output_data;
+        const cl_uint* output = host_ptr_;
+        if (direction_ != TransferDirection::kDeviceToHost) {
+            output_data.resize(count);
+            device_->GetQueue().enqueue_read_buffer(device_buffer_, 0, size_, output_data.data());
+            output = output_data.data();
+        }
+        for (size_t i = 0; i < count; ++i) {
+            const cl_uint expected =
+                method_ == TransferMethod::kFillBuffer ? kFillPattern : static_cast<cl_uint>(i);
+            if (output[i] != expected) {
+                throw DataVerificationFailedException(
+                    (boost::format("Result verification has failed for memory bandwidth fixture. "
+                                   "Value %1% at index %2% is not equal to expected %3%.") %
+                     output[i] % i % expected)
+                        .str());
+            }
+        }
+    }
+
+    std::unordered_map<std::string, double> ExecutionMetrics() override {
+        if (min_duration_ == Duration()) {
+            return {};
+        }
+        const double seconds = min_duration_.AsSeconds();
+        return {{"Bandwidth, GB/s", static_cast<double>(size_) / seconds * 1e-9},
+                {"Latency, us", seconds * 1e6}};
+    }
+
+    std::shared_ptr<DeviceInterface> Device() override { return device_; }
+
+    std::string Algorithm() override { return AlgorithmName(method_); }
+
+    static std::string AlgorithmName(TransferMethod method) {
+        switch (method) {
+            case TransferMethod::kPinned:
+                return "pinned host memory";
+            case TransferMethod::kMapUnmap:
+                return "map, copy on host, unmap";
+            case TransferMethod::kCopyBuffer:
+                return "copy buffer";
+            case TransferMethod::kFillBuffer:
+                return "fill buffer";
+            case TransferMethod::kPageable:
+            default:
+                return "pageable host memory";
+        }
+    }
+
+    static std::string DirectionName(TransferDirection direction) {
+        switch (direction) {
+            case TransferDirection::kDeviceToHost:
+                return "device to host";
+            case TransferDirection::kDeviceToDevice:
+                return "device to device";
+            case TransferDirection::kHostToDevice:
+            default:
+                return "host to device";
+        }
+    }
+
+    // Methods which can transfer data in a given direction, the first one is a baseline
+    static std::vector<TransferMethod> GetTransferMethods(TransferDirection direction) {
+        if (direction == TransferDirection::kDeviceToDevice) {
+            return {TransferMethod::kCopyBuffer, TransferMethod::kFillBuffer};
+        }
+        return {TransferMethod::kPageable, TransferMethod::kPinned, TransferMethod::kMapUnmap};
+    }
+
+    virtual ~MemoryBandwidthOpenClFixture() noexcept {
+        if (pinned_buffer_.get() != nullptr && host_ptr_ != nullptr) {
+            try {
+                device_->GetQueue().enqueue_unmap_buffer(pinned_buffer_, host_ptr_).wait();
+            } catch (std::exception&) {
+                // Buffer is released anyway, nothing else can be done in a destructor
+            }
+        }
+    }
+
+private:
+    // Transfer is a single command, it is timed by profiling info
+    std::unordered_map<std::string, Duration> ExecuteEnqueued() {
+        boost::compute::command_queue& queue = device_->GetQueue();
+        std::unordered_map<std::string, boost::compute::event> events;
+        if (method_ == TransferMethod::kFillBuffer) {
+            const cl_uint pattern = kFillPattern;
+            events.insert(
+                {"Filling", queue.enqueue_fill_buffer(
+                                device_buffer_, &pattern, sizeof(pattern), 0, size_)});
+        } else if (method_ == TransferMethod::kCopyBuffer) {
+            events.insert(
+                {"Copying data",
+                 queue.enqueue_copy_buffer(source_buffer_, device_buffer_, 0, 0, size_)});
+        } else if (direction_ == TransferDirection::kHostToDevice) {
+            events.insert(
+                {"Copying data",
+                 queue.enqueue_write_buffer_async(device_buffer_, 0, size_, host_ptr_)});
+        } else {
+            events.insert(
+                {"Copying data",
+                 queue.enqueue_read_buffer_async(device_buffer_, 0, size_, host_ptr_)});
+        }
+        events.begin()->second.wait();
+        return Utils::GetOpenCLEventDurations(events);
+    }
+
+    // Mapping and unmapping are timed by profiling info, copying by host wall time
+    std::unordered_map<std::string, Duration> ExecuteMapUnmap() {
+        typedef std::chrono::steady_clock Clock;
+        boost::compute::command_queue& queue = device_->GetQueue();
+        std::unordered_map<std::string, boost::compute::event> events;
+
+        // Previous contents of a destination don't have to be copied to host
+        const cl_map_flags flags = direction_ == TransferDirection::kHostToDevice
+                                       ? CL_MAP_WRITE_INVALIDATE_REGION
+                                       : CL_MAP_READ;
+        boost::compute::event map_event;
+        void* mapped_ptr =
+            queue.enqueue_map_buffer_async(device_buffer_, flags, 0, size_, map_event);
+        map_event.wait();
+        events.insert({"Mapping", map_event});
+
+        const Clock::time_point copy_start = Clock::now();
+        if (direction_ == TransferDirection::kHostToDevice) {
+            std::memcpy(mapped_ptr, host_ptr_, size_);
+        } else {
+            std::memcpy(host_ptr_, mapped_ptr, size_);
+        }
+        const Duration copy_duration(Clock::now() - copy_start);
+
+        boost::compute::event unmap_event = queue.enqueue_unmap_buffer(device_buffer_, mapped_ptr);
+        unmap_event.wait();
+        events.insert({"Unmapping", unmap_event});
+
+        std::unordered_map<std::string, Duration> durations =
+            Utils::GetOpenCLEventDurations(events);
+        durations.insert({"Copying on host", copy_duration});
+        return durations;
+    }
+
+    const std::shared_ptr<OpenClDevice> device_;
+    const size_t size_;
+    const TransferDirection direction_;
+    const TransferMethod method_;
+    // Destination of device to device transfers, device side of other ones
+    boost::compute::buffer device_buffer_;
+    boost::compute::buffer source_buffer_;
+    boost::compute::buffer pinned_buffer_;
+    // Pageable host memory, unused by kPinned
+    std::vector<cl_uint> host_data_;
+    // Host side of transfers, either host_data_ or mapped pinned_buffer_
+    cl_uint* host_ptr_ = nullptr;
+    // Duration of the fastest iteration
+    Duration min_duration_;
+};
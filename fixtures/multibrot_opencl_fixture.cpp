@@ -22,20 +22,23 @@ template <typename T, typename P>
 MultibrotOpenClFixture<T, P>::MultibrotOpenClFixture(
     const std::shared_ptr<OpenClDevice>& device, size_t width_pix, size_t height_pix,
     std::complex<double> input_min, std::complex<double> input_max, double power,
-    const std::string& fixture_name)
+    const MultibrotKernelOptions& kernel_options, const std::string& fixture_name)
     : device_(device),
       width_pix_(width_pix),
       height_pix_(height_pix),
       input_min_(input_min),
       input_max_(input_max),
       power_(power),
+      kernel_options_(kernel_options),
       fixture_name_(fixture_name),
       output_data_(width_pix * height_pix) {}
 
 template <typename T, typename P>
 void MultibrotOpenClFixture<T, P>::Initialize() {
     calculator_ = std::make_unique<MultibrotOpenClCalculator<T, P>>(
-        device_->device(), device_->GetContext(), width_pix_, height_pix_);
+        device_->device(), device_->GetContext(), width_pix_, height_pix_, kernel_options_);
+    // Build a kernel here so its build time doesn't affect the first execution
+    calculator_->PrepareKernel(power_, ResultTypeConstants<P>::max_iterations);
 }
 
 template <typename T, typename P>
@@ -43,13 +46,25 @@ std::vector<std::string> MultibrotOpenClFixture<T, P>::GetRequiredExtensions() {
     return CollectExtensions<T>();
 }
 
+template <typename T, typename P>
+std::string MultibrotOpenClFixture<T, P>::AlgorithmName(
+    const MultibrotKernelOptions& kernel_options) {
+    std::string result = kernel_options.specialize_integer_powers
+                             ? "specialized integer power function"
+                             : "universal power function";
+    if (kernel_options.fixed_max_iterations) {
+        result += ", fixed max iterations";
+    }
+    return result;
+}
+
 template <typename T, typename P>
 std::unordered_map<std::string, Duration> MultibrotOpenClFixture<T, P>::Execute(
     const RuntimeParams& params) {
     boost::compute::event calc_event;
     auto copy_future = calculator_->Calculate(
         input_min_, input_max_, width_pix_, height_pix_, power_,
-        ResultTypeConstants<cl_uchar>::max_iterations, output_data_.begin(), &calc_event);
+        ResultTypeConstants<P>::max_iterations, output_data_.begin(), &calc_event);
 
     copy_future.wait();
 
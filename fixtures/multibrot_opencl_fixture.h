@@ -17,7 +17,7 @@ public:
     MultibrotOpenClFixture(
         const std::shared_ptr<OpenClDevice>& device, size_t width_pix, size_t height_pix,
         std::complex<double> input_min, std::complex<double> input_max, double power,
-        const std::string& fixture_name);
+        const MultibrotKernelOptions& kernel_options, const std::string& fixture_name);
 
     void Initialize() override;
 
@@ -29,6 +29,10 @@ public:
 
     std::shared_ptr<DeviceInterface> Device() override { return device_; }
 
+    std::string Algorithm() override { return AlgorithmName(kernel_options_); }
+
+    static std::string AlgorithmName(const MultibrotKernelOptions& kernel_options);
+
 private:
     std::shared_ptr<OpenClDevice> device_;
     size_t width_pix_;
@@ -36,6 +40,7 @@ private:
     std::complex<double> input_min_;
     std::complex<double> input_max_;
     double power_;
+    MultibrotKernelOptions kernel_options_;
     std::string fixture_name_;
     std::unique_ptr<MultibrotOpenClCalculator<T, P>> calculator_;
     std::vector<P> output_data_;
@@ -5,9 +5,10 @@
 #include <random>
 
 #include "boost/compute.hpp"
+#include "chunked_pipeline.h"
 #include "data_verification_failed_exception.h"
 #include "fixtures/fixture.h"
-#include "iterators/data_source_adaptor.h"
+#include "fixtures/input_data_cache.h"
 #include "utils.h"
 
 namespace {
@@ -27,23 +28,58 @@ __kernel void TrivialFactorial(__global int* input, __global ulong* output)
     size_t id = get_global_id(0);
     output[id] = FactorialImplementation(input[id]);
 }
+
+// All factorials that fit into ulong
+__constant ulong kFactorials[21] = {
+    1UL, 1UL, 2UL, 6UL, 24UL, 120UL, 720UL, 5040UL, 40320UL, 362880UL, 3628800UL,
+    39916800UL, 479001600UL, 6227020800UL, 87178291200UL, 1307674368000UL,
+    20922789888000UL, 355687428096000UL, 6402373705728000UL, 121645100408832000UL,
+    2432902008176640000UL};
+
+__kernel void TrivialFactorialLookupTable(__global int* input, __global ulong* output)
+{
+    size_t id = get_global_id(0);
+    output[id] = kFactorials[input[id]];
+}
 )";
 
 constexpr const char* const kCompilerOptions = "-Werror";
 }  // namespace
 
+enum class TrivialFactorialAlgorithm {
+    // Every work item multiplies values in a loop, number of iterations depends on input
+    kLoop,
+    // Every work item reads a value from a table in constant memory
+    kLookupTable,
+    // Loop kernel, data is copied and calculated by chunks, so stages of different chunks overlap
+    kPipelined
+};
+
 class TrivialFactorialOpenClFixture : public Fixture {
 public:
     TrivialFactorialOpenClFixture(
         const std::shared_ptr<OpenClDevice>& device,
-        const std::shared_ptr<DataSource<int>>& input_data_source, int data_size)
-        : device_(device), input_data_source_(input_data_source), data_size_(data_size) {}
+        const CachedInputData<int>& input_data,
+        TrivialFactorialAlgorithm algorithm = TrivialFactorialAlgorithm::kLoop,
+        size_t pipeline_chunk_count = 0)
+        : data_size_(static_cast<int>(input_data.size())),
+          cached_input_data_(input_data),
+          device_(device),
+          algorithm_(algorithm),
+          pipeline_(pipeline_chunk_count) {
+        EXCEPTION_ASSERT(
+            algorithm_ != TrivialFactorialAlgorithm::kPipelined || pipeline_chunk_count > 0);
+    }
 
     virtual void Initialize() override {
         GenerateData();
+        if (algorithm_ == TrivialFactorialAlgorithm::kPipelined) {
+            pipeline_.Initialize(device_->GetContext(), device_->device());
+        }
         kernel_ = Utils::BuildKernel(
-            "TrivialFactorial", device_->GetContext(), kTrivialFactorialKernelCode,
-            kCompilerOptions);
+            algorithm_ == TrivialFactorialAlgorithm::kLookupTable ? "TrivialFactorialLookupTable"
+                                                                  : "TrivialFactorial",
+            device_->GetContext(), kTrivialFactorialKernelCode, kCompilerOptions);
     }
 
     virtual std::vector<std::string> GetRequiredExtensions() override {
@@ -52,6 +88,9 @@ public:
 
     std::unordered_map<std::string, Duration> Execute(const RuntimeParams& params) override {
         boost::compute::context& context = device_->GetContext();
+        if (algorithm_ == TrivialFactorialAlgorithm::kPipelined) {
+            return ExecutePipelined();
+        }
         boost::compute::command_queue& queue = device_->GetQueue();
 
         std::unordered_map<std::string, boost::compute::event> events;
@@ -61,7 +100,7 @@ public:
 
         // copy data from the host to the device
         events.insert({"Copying input data", boost::compute::copy_async(
-                                                 input_data_.begin(), input_data_.end(),
+                                                 input_data_->begin(), input_data_->end(),
                                                  input_device_vector.begin(), queue)
                                                  .get_event()});
 
@@ -85,15 +124,15 @@ public:
     }
 
     virtual void VerifyResults() override {
-        if (output_data_.size() != expected_output_data_.size()) {
+        if (output_data_.size() != expected_output_data_->size()) {
             throw std::runtime_error(
                 (boost::format("Result verification has failed for fixture \"%1%\". "
                                "Output data count is another from expected one."))
                     .str());
         }
         auto mismatched_values = std::mismatch(
-            output_data_.cbegin(), output_data_.cend(), expected_output_data_.cbegin(),
-            expected_output_data_.cend());
+            output_data_.cbegin(), output_data_.cend(), expected_output_data_->cbegin(),
+            expected_output_data_->cend());
         if (mismatched_values.first != output_data_.cend()) {
             cl_ulong max_abs_error = *mismatched_values.first - *mismatched_values.second;
             throw DataVerificationFailedException(
@@ -107,31 +146,85 @@ public:
 
     std::shared_ptr<DeviceInterface> Device() override { return device_; }
 
+    std::unordered_map<std::string, double> ExecutionMetrics() override {
+        if (algorithm_ != TrivialFactorialAlgorithm::kPipelined) {
+            return {};
+        }
+        return pipeline_.utilization();
+    }
+
+    std::string Algorithm() override {
+        return algorithm_ == TrivialFactorialAlgorithm::kPipelined
+                   ? PipelinedAlgorithmName(pipeline_.chunk_count())
+                   : AlgorithmName(algorithm_);
+    }
+
+    static std::string AlgorithmName(TrivialFactorialAlgorithm algorithm) {
+        switch (algorithm) {
+            case TrivialFactorialAlgorithm::kLookupTable:
+                return "lookup table in constant memory";
+            case TrivialFactorialAlgorithm::kPipelined:
+                return "loop, pipelined";
+            default:
+                return "loop";
+        }
+    }
+
+    // Pipelined variants differ by a number of chunks
+    static std::string PipelinedAlgorithmName(size_t pipeline_chunk_count) {
+        return (boost::format("%1% by %2% chunks") %
+                AlgorithmName(TrivialFactorialAlgorithm::kPipelined) % pipeline_chunk_count)
+            .str();
+    }
+
     virtual ~TrivialFactorialOpenClFixture() noexcept {}
 
 private:
     const int data_size_;
-    std::vector<int> input_data_;
-    std::vector<cl_ulong> expected_output_data_;
+    // Input and expected output are shared by fixtures of a family
+    std::shared_ptr<const std::vector<int>> input_data_;
+    std::shared_ptr<const std::vector<cl_ulong>> expected_output_data_;
     static const std::unordered_map<int, cl_ulong>
         TrivialFactorialOpenClFixture::correct_factorial_values_;
     std::vector<cl_ulong> output_data_;
-    std::shared_ptr<DataSource<int>> input_data_source_;
+    CachedInputData<int> cached_input_data_;
     boost::compute::kernel kernel_;
     const std::shared_ptr<OpenClDevice> device_;
+    TrivialFactorialAlgorithm algorithm_;
+    ChunkedPipeline pipeline_;
+
+    // Execution of the pipelined algorithm, stages of chunks overlap, so they are timed together
+    std::unordered_map<std::string, Duration> ExecutePipelined() {
+        boost::compute::context& context = device_->GetContext();
+        boost::compute::vector<int> input_device_vector(data_size_, context);
+        boost::compute::vector<cl_ulong> output_device_vector(data_size_, context);
+        kernel_.set_arg(0, input_device_vector);
+        kernel_.set_arg(1, output_device_vector);
+
+        output_data_.resize(data_size_);
+        const Duration duration = pipeline_.Run(
+            kernel_, input_data_->data(), input_device_vector.get_buffer(), output_data_.data(),
+            output_device_vector.get_buffer(), data_size_);
+        return {{"Pipelined copying and calculating", duration}};
+    }
 
     void GenerateData() {
-        input_data_.resize(data_size_);
-        std::copy_n(DataSourceAdaptor<int>{input_data_source_}, data_size_, input_data_.begin());
+        input_data_ = cached_input_data_.Get();
 
         // Verify that all input values are in range [0, 20]
         EXCEPTION_ASSERT(std::all_of(
-            input_data_.begin(), input_data_.end(), [](int i) { return i >= 0 && i <= 20; }));
-
-        expected_output_data_.reserve(data_size_);
-        std::transform(
-            input_data_.begin(), input_data_.end(), std::back_inserter(expected_output_data_),
-            [this](int i) { return correct_factorial_values_.at(i); });
+            input_data_->begin(), input_data_->end(), [](int i) { return i >= 0 && i <= 20; }));
+
+        expected_output_data_ =
+            cached_input_data_.GetOrCreate<std::vector<cl_ulong>>([this]() {
+                std::vector<cl_ulong> expected_output_data;
+                expected_output_data.reserve(data_size_);
+                std::transform(
+                    input_data_->begin(), input_data_->end(),
+                    std::back_inserter(expected_output_data),
+                    [](int i) { return correct_factorial_values_.at(i); });
+                return expected_output_data;
+            });
     }
 };
 
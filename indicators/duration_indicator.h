@@ -33,6 +33,13 @@ public:
 
     bool IsEmpty() const { return calculated_.total_duration == Duration(); }
 
+    // Average duration of an iteration (sum of all steps)
+    Duration TotalDuration() const { return calculated_.total_duration; }
+
+    const std::unordered_map<std::string, Duration>& StepMinDurations() const {
+        return calculated_.step_min_durations;
+    }
+
 private:
     struct FixtureCalculatedData {
         std::unordered_map<std::string, Duration> step_durations;
@@ -0,0 +1,135 @@
+#ifndef KPV_SCALING_INDICATOR_H_
+#define KPV_SCALING_INDICATOR_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+#include "utils/duration.h"
+
+/*
+Fits durations of fixtures which differ only by element count to a linear model
+    duration = fixed overhead + element count * per element cost
+for every step and for a total duration.
+Crossover element count is a count at which both terms are equal, for larger counts
+fixed overhead takes less than a half of time, so it is a minimal batch size at which
+a device is used efficiently.
+*/
+class ScalingIndicator {
+public:
+    struct Point {
+        int32_t element_count;
+        // Minimal durations are expected, they are the least affected by noise
+        std::unordered_map<std::string, Duration> step_durations;
+    };
+
+    explicit ScalingIndicator(const std::vector<Point>& points) { Calculate(points); }
+
+    void SerializeValue(nlohmann::json& tree) {
+        for (const Point& point : points_) {
+            tree["elementCounts"].push_back(point.element_count);
+        }
+        for (auto& step_data : calculated_.step_models) {
+            SerializeModel(step_data.second, tree["steps"][step_data.first]);
+        }
+        SerializeModel(calculated_.total_model, tree["total"]);
+    }
+
+    // Model can be fitted only for at least two different element counts
+    bool IsEmpty() const { return calculated_.step_models.empty(); }
+
+private:
+    struct LinearModel {
+        Duration fixed_overhead;
+        Duration per_element_cost;
+    };
+
+    struct ScalingCalculatedData {
+        std::map<std::string, LinearModel> step_models;
+        LinearModel total_model;
+    };
+
+    void Calculate(const std::vector<Point>& points) {
+        points_ = points;
+        std::map<std::string, std::vector<std::pair<double, double>>> step_points;
+        std::vector<std::pair<double, double>> total_points;
+        for (const Point& point : points) {
+            Duration total_duration;
+            for (auto& step_data : point.step_durations) {
+                step_points[step_data.first].push_back(
+                    {static_cast<double>(point.element_count),
+                     step_data.second.duration().count()});
+                total_duration += step_data.second;
+            }
+            total_points.push_back(
+                {static_cast<double>(point.element_count), total_duration.duration().count()});
+        }
+
+        for (auto& step_data : step_points) {
+            if (HasDifferentElementCounts(step_data.second)) {
+                calculated_.step_models[step_data.first] = Fit(step_data.second);
+            }
+        }
+        if (HasDifferentElementCounts(total_points)) {
+            calculated_.total_model = Fit(total_points);
+        }
+    }
+
+    static bool HasDifferentElementCounts(const std::vector<std::pair<double, double>>& points) {
+        for (const auto& point : points) {
+            if (point.first != points.front().first) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /*
+    Least squares fit of (element count, duration in ns) points, errors are relative to
+    durations, so small element counts (which determine fixed overhead) are not dominated by
+    large ones. Both terms can't be negative, if unconstrained fit gives a negative one,
+    it is fixed to zero and the other one is fitted again.
+    */
+    static LinearModel Fit(const std::vector<std::pair<double, double>>& points) {
+        double sum_w = 0.0, sum_wx = 0.0, sum_wy = 0.0, sum_wxx = 0.0, sum_wxy = 0.0;
+        for (const auto& point : points) {
+            const double y = std::max(point.second, 1.0);
+            const double w = 1.0 / (y * y);
+            sum_w += w;
+            sum_wx += w * point.first;
+            sum_wy += w * point.second;
+            sum_wxx += w * point.first * point.first;
+            sum_wxy += w * point.first * point.second;
+        }
+        double slope = (sum_w * sum_wxy - sum_wx * sum_wy) / (sum_w * sum_wxx - sum_wx * sum_wx);
+        double intercept = (sum_wy - slope * sum_wx) / sum_w;
+        if (intercept < 0.0) {
+            intercept = 0.0;
+            slope = sum_wxy / sum_wxx;
+        }
+        if (slope < 0.0) {
+            slope = 0.0;
+            intercept = sum_wy / sum_w;
+        }
+        typedef std::chrono::duration<double, std::nano> Nanoseconds;
+        return {Duration(Nanoseconds(intercept)), Duration(Nanoseconds(slope))};
+    }
+
+    static void SerializeModel(const LinearModel& model, nlohmann::json& tree) {
+        tree["fixedOverhead"] = model.fixed_overhead;
+        tree["perElementCost"] = model.per_element_cost;
+        if (model.per_element_cost != Duration()) {
+            tree["crossoverElementCount"] = model.fixed_overhead / model.per_element_cost;
+        }
+    }
+
+    std::vector<Point> points_;
+    ScalingCalculatedData calculated_;
+};
+
+#endif  // KPV_SCALING_INDICATOR_H_
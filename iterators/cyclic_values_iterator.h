@@ -0,0 +1,74 @@
+#pragma once
+
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+#include "iterators/data_source.h"
+
+/*
+Iterator that cycles through a given list of values.
+It is a constant (input only) forward iterators that return values of template type T.
+Every value of the list is returned "repeat_count" times in a row, then the next one is
+returned, after the last value the first one is returned again. So {0, 1} with repeat count 1
+produces 0, 1, 0, 1, ..., and with repeat count 3 it produces 0, 0, 0, 1, 1, 1, 0, ...
+Every value can be retrieved using dereferencing multiple times.
+This iterator is always referenceable.
+*/
+template <typename T>
+class CyclicValuesIterator final : public std::iterator<std::forward_iterator_tag, T>,
+                                   public DataSource<T> {
+public:
+    CyclicValuesIterator(const std::vector<T>& values, size_t repeat_count = 1)
+        : values_(values), repeat_count_(repeat_count) {
+        if (values_.empty() || repeat_count_ == 0) {
+            throw std::invalid_argument(
+                "CyclicValuesIterator requires at least one value and non-zero repeat count");
+        }
+    }
+
+    CyclicValuesIterator(const CyclicValuesIterator<T>&) = default;
+    CyclicValuesIterator<T>& operator=(const CyclicValuesIterator<T>&) = default;
+
+    bool operator==(const CyclicValuesIterator<T>& rhs) {
+        return values_ == rhs.values_ && repeat_count_ == rhs.repeat_count_ &&
+               value_index_ == rhs.value_index_ && repetition_ == rhs.repetition_;
+    }
+    bool operator!=(const CyclicValuesIterator<T>& rhs) { return !(*this == rhs); }
+
+    T operator*() { return Get(); }
+
+    const T operator*() const { return values_[value_index_]; }
+
+    CyclicValuesIterator<T>& operator++() {
+        Increment();
+        return *this;
+    }
+
+    const CyclicValuesIterator<T> operator++(int) {
+        CyclicValuesIterator<T> temp = *this;
+        ++(*this);
+        return temp;
+    }
+
+    T Get() override { return values_[value_index_]; }
+
+    void Increment() override {
+        if (++repetition_ == repeat_count_) {
+            repetition_ = 0;
+            value_index_ = (value_index_ + 1) % values_.size();
+        }
+    }
+
+    void Fill(T* dst, size_t n, size_t offset) const override {
+        for (size_t i = 0; i < n; ++i) {
+            dst[i] = values_[((offset + i) / repeat_count_) % values_.size()];
+        }
+    }
+
+private:
+    std::vector<T> values_;
+    size_t repeat_count_;
+    size_t value_index_ = 0;
+    size_t repetition_ = 0;
+};
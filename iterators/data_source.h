@@ -1,5 +1,10 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
 /*
 Data source, the same thing as input or forward iterator but implemented using abstract methods
 so pointer to implementation can be used without making it a template (simplifies some things).
@@ -14,5 +19,41 @@ class DataSource {
 public:
     virtual T Get() = 0;
     virtual void Increment() = 0;
+
+    /*
+    Writes n values of the sequence starting from a given offset (index of a value from the
+    beginning of the sequence, regardless of current position of Get()/Increment()) to dst.
+    Result depends only on offset and n, so the method may be called from many threads at once
+    for different parts of a sequence.
+    */
+    virtual void Fill(T* dst, size_t n, size_t offset) const = 0;
+
     virtual ~DataSource() noexcept {}
 };
+
+/*
+Writes the first n values of a data source to dst, parts of the sequence are generated
+by all available hardware threads.
+*/
+template <typename T>
+void FillInParallel(const DataSource<T>& data_source, T* dst, size_t n) {
+    // Small sequences are not worth starting threads
+    const size_t kMinValuesPerThread = 1 << 16;
+    const size_t thread_count = std::max<size_t>(
+        1, std::min<size_t>(std::thread::hardware_concurrency(), n / kMinValuesPerThread));
+    if (thread_count == 1) {
+        data_source.Fill(dst, n, 0);
+        return;
+    }
+    std::vector<std::thread> threads;
+    const size_t values_per_thread = (n + thread_count - 1) / thread_count;
+    for (size_t begin = 0; begin < n; begin += values_per_thread) {
+        const size_t count = std::min(values_per_thread, n - begin);
+        threads.emplace_back([&data_source, dst, begin, count]() {
+            data_source.Fill(dst + begin, count, begin);
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
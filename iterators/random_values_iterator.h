@@ -1,37 +1,60 @@
 #pragma once
 
-#include <boost/random/taus88.hpp>
+#include <cstdint>
 #include <iterator>
+#include <random>
 
 #include "iterators/data_source.h"
+#include "utils/philox.h"
+
+/*
+Seed of random values iterators that are constructed without an explicit one. It is picked
+randomly once per process unless it is set before (e.g. from the command line). It should be
+recorded in a report, so a run can be replayed with exactly the same input data.
+*/
+inline uint64_t& DefaultRandomSeedStorage() {
+    static uint64_t seed = []() {
+        std::random_device random_device;
+        return (static_cast<uint64_t>(random_device()) << 32) | random_device();
+    }();
+    return seed;
+}
+
+inline uint64_t GetDefaultRandomSeed() { return DefaultRandomSeedStorage(); }
+
+inline void SetDefaultRandomSeed(uint64_t seed) { DefaultRandomSeedStorage() = seed; }
 
 /*
 Iterator that generates random values of a given type using a distribution given as a
 constructor parameter.
 It is an input iterators that return values of template type T.
-Every value can be retrieved only once, dereferencing again will produce another random value.
+Every value is generated from its own stream of a counter-based generator (Philox) given by
+a seed and an index of the value, so the sequence depends only on the seed and the distribution
+implementation, and any part of it can be generated independently.
+Every value can be retrieved using dereferencing multiple times.
 This iterator is always referenceable.
 */
 template <typename T, typename D>
 class RandomValuesIterator final : public std::iterator<std::input_iterator_tag, T>,
                                    public DataSource<T> {
 public:
-    RandomValuesIterator(const D& distribution)
-        : distribution_(distribution),
-          generator_(std::random_device()())  // TODO Not sure if this initialization is good
-    {}
+    explicit RandomValuesIterator(const D& distribution, uint64_t seed = GetDefaultRandomSeed())
+        : distribution_(distribution), seed_(seed) {}
 
     RandomValuesIterator(const RandomValuesIterator<T, D>&) = default;
     RandomValuesIterator<T, D>& operator=(const RandomValuesIterator<T, D>&) = default;
 
     bool operator==(const RandomValuesIterator<T, D>& rhs) {
-        return distribution_ == rhs.distribution_ && generator_ == rhs.generator_;
+        return distribution_ == rhs.distribution_ && seed_ == rhs.seed_ && index_ == rhs.index_;
     }
     bool operator!=(const RandomValuesIterator<T, D>& rhs) { return !(*this == rhs); }
 
     T operator*() { return Get(); }
 
-    RandomValuesIterator<T, D>& operator++() { return *this; }
+    RandomValuesIterator<T, D>& operator++() {
+        Increment();
+        return *this;
+    }
 
     const RandomValuesIterator<T, D> operator++(int) {
         RandomValuesIterator<T, D> temp = *this;
@@ -39,22 +62,28 @@ public:
         return temp;
     }
 
-    T Get() override { return distribution_(generator_); }
+    T Get() override { return ValueAt(index_); }
+
+    void Increment() override { ++index_; }
 
-    void Increment() override {
-        // Do nothing here, next value will be different anyways
+    void Fill(T* dst, size_t n, size_t offset) const override {
+        for (size_t i = 0; i < n; ++i) {
+            dst[i] = ValueAt(offset + i);
+        }
     }
 
+    uint64_t seed() const { return seed_; }
+
 private:
-    /* Choosing a random number generator is a bit tricky here.
-    A popular choice is Mersenne twister (e.g. std::mt19937), but according to
-    http://www.boost.org/doc/libs/1_65_1/doc/html/boost_random/reference.html#boost_random.reference.generators
-    it has a pretty big memory footprint ( 625*sizeof(uint32_t) ).
-    Of course different implementations doesn't have to behave in this way, but I believe
-    it is pretty common since it is an algorithm property.
-    So instead boost::random::taus88 is used. It is just as fast, but smaller and has
-    an acceptable period
-    */
-    boost::random::taus88 generator_;
+    T ValueAt(size_t index) const {
+        // Distributions may keep a state (e.g. a cached value of a normal distribution),
+        // so every value uses a fresh copy
+        D distribution = distribution_;
+        Philox4x32 generator(seed_, index);
+        return distribution(generator);
+    }
+
     D distribution_;
+    uint64_t seed_;
+    size_t index_ = 0;
 };
@@ -10,25 +10,28 @@ It is a constant (input only) forward iterators that return values of template t
 First returned value is equal to constructor parameter "startValue",
 incrementing iterator increases returned value by "step".
 Every value can be retrieved using dereferencing multiple times.
+Values are calculated as startValue + index * step (with double precision for floating point
+types), so they don't accumulate rounding errors and any of them can be got directly.
 This iterator is always referenceable.
 */
 template <typename T>
 class SequentialValuesIterator final : public std::iterator<std::forward_iterator_tag, T>,
                                        public DataSource<T> {
 public:
-    SequentialValuesIterator(T startValue, T step) : value_(startValue), step_(step) {}
+    SequentialValuesIterator(T startValue, T step) : start_value_(startValue), step_(step) {}
 
     SequentialValuesIterator(const SequentialValuesIterator<T>&) = default;
     SequentialValuesIterator<T>& operator=(const SequentialValuesIterator<T>&) = default;
 
     bool operator==(const SequentialValuesIterator<T>& rhs) {
-        return (step_ == rhs.step_) && (value_ == rhs.value_);
+        return (step_ == rhs.step_) && (start_value_ == rhs.start_value_) &&
+               (index_ == rhs.index_);
     }
     bool operator!=(const SequentialValuesIterator<T>& rhs) { return !(*this == rhs); }
 
     T operator*() { return Get(); }
 
-    const T operator*() const { return value_; }
+    const T operator*() const { return ValueAt(index_); }
 
     SequentialValuesIterator<T>& operator++() {
         Increment();
@@ -41,11 +44,24 @@ public:
         return temp;
     }
 
-    T Get() override { return value_; }
+    T Get() override { return ValueAt(index_); }
 
-    void Increment() override { value_ += step_; }
+    void Increment() override { ++index_; }
+
+    void Fill(T* dst, size_t n, size_t offset) const override {
+        for (size_t i = 0; i < n; ++i) {
+            dst[i] = ValueAt(offset + i);
+        }
+    }
 
 private:
-    T value_;
+    T ValueAt(size_t index) const {
+        return static_cast<T>(
+            static_cast<double>(start_value_) +
+            static_cast<double>(index) * static_cast<double>(step_));
+    }
+
+    T start_value_;
     T step_;
+    size_t index_ = 0;
 };
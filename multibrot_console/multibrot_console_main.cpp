@@ -4,15 +4,21 @@
 #include <boost/log/expressions.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/program_options.hpp>
+#include <chrono>
 #include <cstdlib>
+#include <future>
+#include <iomanip>
 #include <iostream>
 #include <regex>
+#include <sstream>
 #include <string>
 
 #include "coordinate_formatter.h"
 #include "lodepng/source/lodepng.h"
 #include "multibrot_opencl/multibrot_parallel_calculator.h"
+#include "render_journal.h"
 #include "utils/utils.h"
+#include "zoom_path.h"
 
 #ifdef WIN32
 #include <tchar.h>
@@ -23,6 +29,8 @@ namespace {
 constexpr const char* kDefaultSizePix = "10000x10000";
 constexpr const char* kFirstPhaseTempFileRegexpr = R"(^multibrot_\d+_\d+\.png$)";
 constexpr const char* kRowTempFileRegexpr = R"(row_\d+\.png)";
+constexpr const char* kPartialTempFileRegexpr = R"(^multibrot_\d+_\d+\.png\.part$)";
+constexpr const char* kJournalFileName = "journal.txt";
 
 template <typename P>
 struct Constants {
@@ -91,8 +99,36 @@ void PrepareTempFolder() {
     }
 }
 
+struct RenderSettings {
+    size_t total_width = 0;
+    size_t total_height = 0;
+    double power = 2.0;
+    int max_iterations = 255;
+    MultibrotKernelOptions kernel_options;
+    // If not empty, a zoom animation is built using keyframes from this file
+    std::string zoom_path_file;
+    // Continue previous render using its journal
+    bool resume = false;
+};
+
+// Describes render parameters, a journal can be used only by a render with the same description
 template <typename P>
-void Execute(size_t total_width, size_t total_height, double power, int max_iterations) {
+std::string DescribeRender(
+    const RenderSettings& settings, std::complex<double> min, std::complex<double> max) {
+    std::ostringstream stream;
+    stream << std::setprecision(17) << "size " << settings.total_width << "x"
+           << settings.total_height << " region " << min << " " << max << " power "
+           << settings.power << " max_iterations " << settings.max_iterations << " pixel_format "
+           << Constants<P>::pixel_format << " bit_depth " << Constants<P>::bit_depth;
+    return stream.str();
+}
+
+template <typename P>
+void Execute(const RenderSettings& settings) {
+    const size_t total_width = settings.total_width;
+    const size_t total_height = settings.total_height;
+    const double power = settings.power;
+    const int max_iterations = settings.max_iterations;
     CoordinateFormatter formatter{total_width, total_height};
 
     std::complex<double> min{-2.5, -2.0};
@@ -100,12 +136,19 @@ void Execute(size_t total_width, size_t total_height, double power, int max_iter
     MultibrotParallelCalculator<P> calculator{
         total_width,
         total_height,
+        settings.kernel_options,
     };
 
     PrepareTempFolder();
-    BOOST_LOG_TRIVIAL(info) << "Deleting left-over temporary files from previous operation "
-                               "multibrot_*_xxxxx.png";
-    RemoveTemporaryFiles(kFirstPhaseTempFileRegexpr);
+    if (settings.resume) {
+        BOOST_LOG_TRIVIAL(info) << "Resuming previous render, keeping its temporary files "
+                                   "multibrot_*_xxxxx.png";
+    } else {
+        BOOST_LOG_TRIVIAL(info) << "Deleting left-over temporary files from previous operation "
+                                   "multibrot_*_xxxxx.png";
+        RemoveTemporaryFiles(kFirstPhaseTempFileRegexpr);
+    }
+    RemoveTemporaryFiles(kPartialTempFileRegexpr);
 
     BOOST_LOG_TRIVIAL(info) << "Deleting left-over temporary files from previous operation "
                                "row_xxxxx.png";
@@ -117,6 +160,16 @@ void Execute(size_t total_width, size_t total_height, double power, int max_iter
     std::unordered_map<size_t, std::vector<ImagePartitioner::Segment>> segments;
     const boost::filesystem::path temp_folder{FindTempDirectory()};
 
+    RenderJournal journal{
+        temp_folder / kJournalFileName, DescribeRender<P>(settings, min, max), settings.resume};
+    for (const RenderJournal::Entry& entry : journal.CompletedEntries()) {
+        segments[entry.segment.y].push_back(entry.segment);
+    }
+    if (settings.resume) {
+        BOOST_LOG_TRIVIAL(info) << journal.CompletedEntries().size()
+                                << " segments are restored from a previous render";
+    }
+
     calculator.Calculate(
         min, max, power, max_iterations,
         [&](const boost::compute::device& device, const ImagePartitioner::Segment& segment,
@@ -133,19 +186,26 @@ void Execute(size_t total_width, size_t total_height, double power, int max_iter
             std::string filename = (boost::format("multibrot_%1%_%2%.png") %
                                     formatter.Format(segment.x) % formatter.Format(segment.y))
                                        .str();
+            // Write to a partial file first and then rename it, so a file mentioned in
+            // the journal is always complete
+            const boost::filesystem::path partial_path = temp_folder / (filename + ".part");
             unsigned error = lodepng::encode(
-                (temp_folder / filename).string(), reinterpret_cast<const unsigned char*>(result),
+                partial_path.string(), reinterpret_cast<const unsigned char*>(result),
                 segment.width_pix, segment.height_pix, Constants<P>::pixel_format,
                 Constants<P>::bit_depth);
             if (error) {
                 BOOST_LOG_TRIVIAL(info) << "Error when building PNG based on data by device "
                                         << device.name() << " with size " << segment.width_pix
                                         << "x" << segment.height_pix << " pixels.";
+                return;
             }
+            boost::filesystem::rename(partial_path, temp_folder / filename);
+            journal.Append(RenderJournal::Entry{segment, filename});
             BOOST_LOG_TRIVIAL(info)
                 << "Batch on device " << device.name() << " with size " << segment.width_pix << "x"
                 << segment.height_pix << " pixels finished.";
-        });
+        },
+        journal.CompletedSegments());
 
     for (auto& row : segments) {
         // TODO change call to ImageMagick by Magick++ library, that way there's no need
@@ -161,6 +221,8 @@ void Execute(size_t total_width, size_t total_height, double power, int max_iter
                           .c_str());
     }
 
+    // Segment files are going to be deleted, journal is no longer valid
+    journal.Remove();
     BOOST_LOG_TRIVIAL(info) << "Deleting temporary files multibrot_*_xxxxx.png";
     RemoveTemporaryFiles(kFirstPhaseTempFileRegexpr);
 
@@ -176,6 +238,99 @@ void Execute(size_t total_width, size_t total_height, double power, int max_iter
     BOOST_LOG_TRIVIAL(info) << "Deleting temporary files row_xxxxx.png";
     RemoveTemporaryFiles(kRowTempFileRegexpr);
 }
+
+/*
+Builds a zoom animation, one PNG file per frame.
+Calculator (and so all OpenCL contexts, kernels and buffers) is created once and reused
+for all frames. Frames are double-buffered: while frame N is encoded to PNG on a background
+thread, frame N+1 is calculated by devices.
+*/
+template <typename P>
+void ExecuteAnimation(const RenderSettings& settings) {
+    typedef std::chrono::steady_clock Clock;
+    const size_t total_width = settings.total_width;
+    const size_t total_height = settings.total_height;
+    const ZoomPath zoom_path = ZoomPath::ReadFromFile(settings.zoom_path_file);
+    const size_t frame_count = zoom_path.FrameCount();
+    const double aspect_ratio = static_cast<double>(total_height) / total_width;
+    CoordinateFormatter formatter{frame_count, 0};
+
+    BOOST_LOG_TRIVIAL(info) << "Building zoom animation with " << frame_count << " frames of "
+                            << total_width << "x" << total_height << " pixels";
+
+    MultibrotParallelCalculator<P> calculator{
+        total_width,
+        total_height,
+        settings.kernel_options,
+    };
+
+    std::vector<P> frame_buffers[2] = {
+        std::vector<P>(total_width * total_height), std::vector<P>(total_width * total_height)};
+    // Encoding of a previous frame that may still be in progress
+    std::future<void> encode_future;
+
+    const Clock::time_point start_time = Clock::now();
+    for (size_t frame_index = 0; frame_index < frame_count; ++frame_index) {
+        const Clock::time_point frame_start_time = Clock::now();
+        // This buffer was used by frame N-2, its encoding finished before frame N-1 was
+        // passed to the background thread
+        std::vector<P>& frame = frame_buffers[frame_index % 2];
+
+        std::complex<double> min, max;
+        zoom_path.FrameRegion(frame_index, aspect_ratio, &min, &max);
+        calculator.Calculate(
+            min, max, settings.power, settings.max_iterations,
+            [&](const boost::compute::device& /* device */,
+                const ImagePartitioner::Segment& segment, const P* result) {
+                for (size_t row = 0; row < segment.height_pix; ++row) {
+                    std::copy(
+                        result + row * segment.width_pix,
+                        result + (row + 1) * segment.width_pix,
+                        frame.begin() + (segment.y + row) * total_width + segment.x);
+                }
+            });
+        const Duration calc_duration{Clock::now() - frame_start_time};
+
+        if (encode_future.valid()) {
+            encode_future.get();  // Rethrows encoding errors if any
+        }
+        std::string filename =
+            (boost::format("multibrot_frame_%1%.png") % formatter.Format(frame_index)).str();
+        encode_future = std::async(std::launch::async, [&frame, filename, total_width,
+                                                         total_height]() {
+            unsigned error = lodepng::encode(
+                filename, reinterpret_cast<const unsigned char*>(frame.data()), total_width,
+                total_height, Constants<P>::pixel_format, Constants<P>::bit_depth);
+            if (error) {
+                throw std::runtime_error(
+                    "Error when building PNG " + filename + ": " + lodepng_error_text(error));
+            }
+        });
+
+        const Duration elapsed{Clock::now() - start_time};
+        BOOST_LOG_TRIVIAL(info) << "Frame " << frame_index + 1 << "/" << frame_count
+                                << " calculated in " << calc_duration.AsSeconds()
+                                << " s, sustained rate is "
+                                << (frame_index + 1) / elapsed.AsSeconds() << " frames/s";
+    }
+    if (encode_future.valid()) {
+        encode_future.get();
+    }
+
+    const Duration total_duration{Clock::now() - start_time};
+    BOOST_LOG_TRIVIAL(info) << "Built " << frame_count << " frames in "
+                            << total_duration.AsSeconds() << " s, "
+                            << frame_count / total_duration.AsSeconds() << " frames/s";
+}
+
+template <typename P>
+void Run(const RenderSettings& settings) {
+    if (settings.zoom_path_file.empty()) {
+        Execute<P>(settings);
+    } else {
+        ExecuteAnimation<P>(settings);
+    }
+}
 }  // namespace
 
 int main(int argc, char** argv) {
@@ -186,6 +341,7 @@ int main(int argc, char** argv) {
     bool color = true;
     std::string size_pix;
     int max_iterations = 255;
+    std::string zoom_path_file;
     boost::program_options::options_description desc("Multibrot set plotter - console version.");
     {
         using namespace boost::program_options;
@@ -209,6 +365,19 @@ int main(int argc, char** argv) {
                 "max iteration number. Must be less or equal to 255 "
                 "if bit depth is 8, or less or equal to 2^16 (65535) if bit depth is 16. "
                 "Default value is 255.")
+            ("zoom-path,z", value<std::string>(&zoom_path_file),
+                "build a zoom animation instead of a single image. Value is a path to a file "
+                "with keyframes, one per line: <center real> <center imaginary> <scale> "
+                "<frame count>. Scale is the visible width along the real axis, frame count is "
+                "a number of frames built on the way to the next keyframe. Every frame is "
+                "written to multibrot_frame_xxxxx.png in the current folder.")
+            ("universal-power", "always use the universal power function. By default kernels "
+                "with a power function generated for a given power are used when it is integer.")
+            ("fixed-max-iterations", "build kernels with max iteration number as a compile-time "
+                "constant. Allows compiler to optimize better but every distinct value "
+                "requires its own kernel.")
+            ("resume,r", "continue an interrupted render with the same parameters. Segments "
+                "recorded in its journal are not calculated again.")
             ;
         // clang-format on
     }
@@ -280,18 +449,33 @@ int main(int argc, char** argv) {
         return EXIT_FAILURE;
     }
 
+    RenderSettings settings;
+    settings.total_width = total_width;
+    settings.total_height = total_height;
+    settings.power = power;
+    settings.max_iterations = max_iterations;
+    settings.zoom_path_file = zoom_path_file;
+    settings.resume = vm.count("resume") > 0;
+    if (settings.resume && !settings.zoom_path_file.empty()) {
+        BOOST_LOG_TRIVIAL(fatal) << "Resuming is not supported for zoom animations.";
+        BOOST_LOG_TRIVIAL(fatal) << desc;
+        return EXIT_FAILURE;
+    }
+    settings.kernel_options.specialize_integer_powers = vm.count("universal-power") == 0;
+    settings.kernel_options.fixed_max_iterations = vm.count("fixed-max-iterations") > 0;
+
     try {
         if (color) {
             if (bitdepth == 8) {
-                Execute<cl_uchar4>(total_width, total_height, power, max_iterations);
+                Run<cl_uchar4>(settings);
             } else if (bitdepth == 16) {
-                Execute<cl_ushort4>(total_width, total_height, power, max_iterations);
+                Run<cl_ushort4>(settings);
             }
         } else {
             if (bitdepth == 8) {
-                Execute<cl_uchar>(total_width, total_height, power, max_iterations);
+                Run<cl_uchar>(settings);
             } else if (bitdepth == 16) {
-                Execute<cl_ushort>(total_width, total_height, power, max_iterations);
+                Run<cl_ushort>(settings);
             }
         }
     } catch (std::exception& e) {
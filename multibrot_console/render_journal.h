@@ -0,0 +1,124 @@
+#pragma once
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "multibrot_opencl/image_partitioner.h"
+
+/*
+Checkpoint journal of a render, allows to continue it after the program was interrupted.
+The first line describes render parameters, every next line is a segment which result is
+completely stored in a file:
+<x> <y> <width> <height> <file name>
+Lines are appended and flushed one by one, only after the segment file is written.
+A line that has no terminating new line symbol (e.g. the program was killed while writing it)
+is ignored when journal is read.
+*/
+class RenderJournal {
+public:
+    struct Entry {
+        ImagePartitioner::Segment segment;
+        std::string file_name;
+    };
+
+    /*
+    Open a journal. If resume is false, a new empty journal is started.
+    Otherwise existing journal is read, it must describe a render with the same parameters,
+    entries which files are missing are dropped.
+    */
+    RenderJournal(
+        const boost::filesystem::path& journal_path, const std::string& description, bool resume)
+        : journal_path_(journal_path) {
+        if (resume) {
+            Read(description);
+        }
+        // Rewrite journal completely, that way incomplete lines and entries without files
+        // are dropped. New journal replaces the old one only when it is completely written.
+        boost::filesystem::path temp_path = journal_path_;
+        temp_path += ".tmp";
+        stream_.open(temp_path.string(), std::ios::out | std::ios::trunc);
+        if (!stream_.is_open()) {
+            throw std::runtime_error("Cannot create render journal " + temp_path.string());
+        }
+        stream_ << description << "\n";
+        for (const Entry& entry : entries_) {
+            WriteEntry(entry);
+        }
+        stream_.close();
+        boost::filesystem::rename(temp_path, journal_path_);
+        stream_.open(journal_path_.string(), std::ios::out | std::ios::app);
+        if (!stream_.is_open()) {
+            throw std::runtime_error("Cannot open render journal " + journal_path_.string());
+        }
+    }
+
+    const std::vector<Entry>& CompletedEntries() const { return entries_; }
+
+    std::vector<ImagePartitioner::Segment> CompletedSegments() const {
+        std::vector<ImagePartitioner::Segment> result;
+        for (const Entry& entry : entries_) {
+            result.push_back(entry.segment);
+        }
+        return result;
+    }
+
+    // Records a completed segment. Must be called after its file is completely written.
+    void Append(const Entry& entry) {
+        WriteEntry(entry);
+        stream_.flush();
+        if (!stream_) {
+            throw std::runtime_error("Cannot write to render journal " + journal_path_.string());
+        }
+        entries_.push_back(entry);
+    }
+
+    // Removes journal file, should be called when render is finished
+    void Remove() {
+        stream_.close();
+        boost::filesystem::remove(journal_path_);
+    }
+
+private:
+    void Read(const std::string& description) {
+        std::ifstream stream(journal_path_.string());
+        if (!stream.is_open()) {
+            throw std::runtime_error(
+                "Cannot resume: render journal " + journal_path_.string() + " is not found.");
+        }
+        std::string line;
+        if (!std::getline(stream, line) || line != description) {
+            throw std::runtime_error(
+                "Cannot resume: render journal " + journal_path_.string() +
+                " belongs to a render with other parameters.");
+        }
+        while (std::getline(stream, line)) {
+            if (stream.eof()) {
+                // Line was not completely written
+                break;
+            }
+            std::istringstream line_stream(line);
+            Entry entry;
+            if (!(line_stream >> entry.segment.x >> entry.segment.y >> entry.segment.width_pix >>
+                  entry.segment.height_pix >> entry.file_name)) {
+                throw std::runtime_error(
+                    "Render journal " + journal_path_.string() + " is corrupted.");
+            }
+            if (boost::filesystem::exists(journal_path_.parent_path() / entry.file_name)) {
+                entries_.push_back(entry);
+            }
+        }
+    }
+
+    void WriteEntry(const Entry& entry) {
+        stream_ << entry.segment.x << " " << entry.segment.y << " " << entry.segment.width_pix
+                << " " << entry.segment.height_pix << " " << entry.file_name << "\n";
+    }
+
+    boost::filesystem::path journal_path_;
+    std::ofstream stream_;
+    std::vector<Entry> entries_;
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cmath>
+#include <complex>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+Keyframed path used to build zoom animations.
+Every keyframe defines a center of the image (complex number), scale (width of the visible
+region along the real axis) and number of frames that are built on the way to the next keyframe.
+The last keyframe is always shown as the last frame, its frame number is ignored.
+
+Scale is interpolated geometrically (so zoom speed looks constant), center moves proportionally
+to scale change, so a point being zoomed in stays at the same place on the screen.
+When two consecutive keyframes have the same scale, center is interpolated linearly.
+*/
+class ZoomPath {
+public:
+    struct Keyframe {
+        std::complex<double> center;
+        double scale = 0.0;
+        size_t frame_count = 0;
+    };
+
+    explicit ZoomPath(const std::vector<Keyframe>& keyframes) : keyframes_(keyframes) {
+        if (keyframes_.empty()) {
+            throw std::invalid_argument("Zoom path must contain at least one keyframe.");
+        }
+        for (const Keyframe& keyframe : keyframes_) {
+            if (!(keyframe.scale > 0.0)) {
+                throw std::invalid_argument("Keyframe scale must be a positive number.");
+            }
+        }
+        for (size_t i = 0; i + 1 < keyframes_.size(); ++i) {
+            if (keyframes_[i].frame_count == 0) {
+                throw std::invalid_argument(
+                    "Every keyframe except the last one must have at least one frame.");
+            }
+        }
+    }
+
+    /*
+    Read keyframes from a text file. Every non-empty line that doesn't start with '#' is
+    a keyframe in the following format:
+    <center real part> <center imaginary part> <scale> <frame count>
+    */
+    static ZoomPath ReadFromFile(const std::string& file_name) {
+        std::ifstream stream(file_name);
+        if (!stream.is_open()) {
+            throw std::runtime_error("Cannot open zoom path file " + file_name);
+        }
+        std::vector<Keyframe> keyframes;
+        std::string line;
+        size_t line_number = 0;
+        while (std::getline(stream, line)) {
+            ++line_number;
+            if (line.find_first_not_of(" \t\r") == std::string::npos || line.front() == '#') {
+                continue;
+            }
+            std::istringstream line_stream(line);
+            double real = 0.0, imag = 0.0;
+            // Read as a signed number, so a negative count isn't silently wrapped around
+            long long frame_count = 0;
+            Keyframe keyframe;
+            if (!(line_stream >> real >> imag >> keyframe.scale >> frame_count) ||
+                frame_count < 0) {
+                throw std::runtime_error(
+                    "Wrong keyframe format in zoom path file " + file_name + ", line " +
+                    std::to_string(line_number));
+            }
+            keyframe.center = {real, imag};
+            keyframe.frame_count = static_cast<size_t>(frame_count);
+            keyframes.push_back(keyframe);
+        }
+        return ZoomPath(keyframes);
+    }
+
+    size_t FrameCount() const {
+        size_t result = 1;  // The last keyframe
+        for (size_t i = 0; i + 1 < keyframes_.size(); ++i) {
+            result += keyframes_[i].frame_count;
+        }
+        return result;
+    }
+
+    /*
+    Calculate a region of complex plane shown on a given frame.
+    aspect_ratio is image height divided by image width.
+    */
+    void FrameRegion(
+        size_t frame_index, double aspect_ratio, std::complex<double>* min,
+        std::complex<double>* max) const {
+        if (frame_index >= FrameCount()) {
+            throw std::out_of_range("Requested frame is out of zoom path.");
+        }
+        std::complex<double> center = keyframes_.back().center;
+        double scale = keyframes_.back().scale;
+        for (size_t i = 0; i + 1 < keyframes_.size(); ++i) {
+            const Keyframe& from = keyframes_[i];
+            const Keyframe& to = keyframes_[i + 1];
+            if (frame_index < from.frame_count) {
+                double t = static_cast<double>(frame_index) / from.frame_count;
+                scale = from.scale * std::pow(to.scale / from.scale, t);
+                double weight = t;
+                if (from.scale != to.scale) {
+                    weight = (from.scale - scale) / (from.scale - to.scale);
+                }
+                center = from.center + (to.center - from.center) * weight;
+                break;
+            }
+            frame_index -= from.frame_count;
+        }
+        std::complex<double> half_size{scale / 2, scale * aspect_ratio / 2};
+        *min = center - half_size;
+        *max = center + half_size;
+    }
+
+private:
+    std::vector<Keyframe> keyframes_;
+};
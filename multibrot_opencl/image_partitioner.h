@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <map>
 #include <stdexcept>
 #include <vector>
 
@@ -12,6 +13,7 @@ constructor parameters). Area width and height doesn't have to be perfectly divi
 by fragment width or height.
 Code tries to use full fragments (edge fragments may be smaller than requested), starting with
 left top ones, moving to the right and then down, row by row. Row height is always one fragment.
+Regions marked as completed (e.g. restored from a previous run) are skipped.
 */
 class ImagePartitioner {
 public:
@@ -54,22 +56,74 @@ public:
                 result.x += last_segment.width_pix;
             }
         }
+        SkipCompletedSegments(result);
         result.width_pix =
             std::min(preferred_fragment_count * fragment_width_pix_, area_width_pix_ - result.x);
+        // Stop before the next completed segment in this row
+        auto row_iter = completed_segments_.find(result.y);
+        if (row_iter != completed_segments_.end()) {
+            auto next_iter = row_iter->second.upper_bound(result.x);
+            if (next_iter != row_iter->second.end()) {
+                result.width_pix = std::min(result.width_pix, next_iter->first - result.x);
+            }
+        }
         result.height_pix = std::min(fragment_height_pix_, area_height_pix_ - result.y);
         segments_.push_back(result);
         return result;
     }
 
-    void Reset() { segments_.clear(); }
+    // Marks a segment as completed, so it won't be returned by Partition().
+    // Segment must be aligned to rows, e.g. returned by Partition() earlier with the same
+    // area and fragment sizes.
+    void MarkCompleted(const Segment& segment) {
+        if (segment.y % fragment_height_pix_ != 0 ||
+            segment.x + segment.width_pix > area_width_pix_ ||
+            segment.y + segment.height_pix > area_height_pix_) {
+            throw std::invalid_argument("Completed segment doesn't fit partitioning.");
+        }
+        if (!segment.IsEmpty()) {
+            completed_segments_[segment.y][segment.x] = segment.width_pix;
+        }
+    }
+
+    void Reset() {
+        segments_.clear();
+        completed_segments_.clear();
+    }
 
 private:
+    // Moves segment start to the first position not covered by completed segments
+    void SkipCompletedSegments(Segment& segment) const {
+        while (segment.y < area_height_pix_) {
+            auto row_iter = completed_segments_.find(segment.y);
+            if (row_iter == completed_segments_.end()) {
+                return;
+            }
+            // Find the last completed segment that starts before or at current position
+            auto completed_iter = row_iter->second.upper_bound(segment.x);
+            if (completed_iter == row_iter->second.begin()) {
+                return;
+            }
+            --completed_iter;
+            if (completed_iter->first + completed_iter->second <= segment.x) {
+                return;
+            }
+            segment.x = completed_iter->first + completed_iter->second;
+            if (segment.x == area_width_pix_) {
+                segment.x = 0;
+                segment.y += std::min(fragment_height_pix_, area_height_pix_ - segment.y);
+            }
+        }
+    }
+
     size_t area_width_pix_;
     size_t area_height_pix_;
     size_t fragment_width_pix_;
     size_t fragment_height_pix_;
     // Segments are stored in a row-by-row basis in ascending order.
     std::vector<Segment> segments_;
+    // Widths of completed segments by their y and x coordinates
+    std::map<size_t /* y */, std::map<size_t /* x */, size_t /* width */>> completed_segments_;
     // TODO since we're deterministic in selecting segments, we can map segment
     // coordinates to a number of a last segment and then store it
 };
@@ -1,6 +1,8 @@
 #include "multibrot_opencl_calculator.h"
 
 #include <boost/format.hpp>
+#include <cmath>
+#include <sstream>
 #include <unordered_map>
 
 namespace {
@@ -19,6 +21,9 @@ Requires a definition:
   In general this function should do the following mathematical operation:
   (zreal, zimg) = (zreal, zimg) ^ power + (real, img)
   Different functions are used for optimisation purposes
+Optional definitions:
+- FIXED_MAX_ITER_NUMBER - max iteration number known at compile time. When given, value passed
+  as a kernel argument is ignored.
 */
 
 // Preprocessor magic based on https://stackoverflow.com/a/1489985
@@ -29,6 +34,12 @@ Requires a definition:
 #define CONVERT EVALUATOR_3(convert_, RESULT_T, _sat)
 #define REAL_T4 EVALUATOR_2(REAL_T, 4)
 
+#ifdef FIXED_MAX_ITER_NUMBER
+#define MAX_ITER_NUMBER FIXED_MAX_ITER_NUMBER
+#else
+#define MAX_ITER_NUMBER max_iter_number
+#endif
+
 // Universal complex number power function, supports all real powers but the slowest
 void UniversalPowerOfComplex(
     __private REAL_T* restrict zreal,
@@ -185,12 +196,85 @@ __kernel void MultibrotSetKernel(
 
     REAL_T real = rmin + get_global_id(0) * rstep;
     REAL_T img = imin + get_global_id(1) * istep;
-    REAL_T multibrot_val = CalcPointOnMultibrotSet( real, img, power, max_iter_number );
-    RESULT_T result = ProcessIterationNumber( multibrot_val, max_iter_number );
+    REAL_T multibrot_val = CalcPointOnMultibrotSet( real, img, power, MAX_ITER_NUMBER );
+    RESULT_T result = ProcessIterationNumber( multibrot_val, MAX_ITER_NUMBER );
     output[result_index] = result;
 }
 )";
 
+// Powers that have hand-written functions in the main program
+const std::unordered_map<double /* power */, std::string> kFixedPowerFunctions = {
+    {1.0, "Power1OfComplex"},
+    {2.0, "SquareOfComplex"},
+    {3.0, "CubeOfComplex"},
+};
+
+// Max power for which a function is generated, larger ones use the universal function
+constexpr double kMaxGeneratedPower = 65535.0;
+
+// Checks if a function for given power should be generated
+bool IsGeneratedPower(double power) {
+    return power >= 1.0 && power <= kMaxGeneratedPower && std::floor(power) == power &&
+           kFixedPowerFunctions.count(power) == 0;
+}
+
+std::string GeneratedPowerFunctionName(int power) {
+    return "PowerOfComplex" + std::to_string(power);
+}
+
+/*
+Generates source of a function that raises Z to a given integer power and adds C,
+with the same signature as functions in the main program.
+Binary exponentiation is unrolled at generation time, so the function contains
+only multiplications and additions, e.g. power 7 needs two squares and two products.
+*/
+std::string GeneratePowerFunction(int power) {
+    std::ostringstream stream;
+    stream << "// Generated function for power " << power << "\n"
+           << "void " << GeneratedPowerFunctionName(power) << "(\n"
+           << "    __private REAL_T* restrict zreal,\n"
+           << "    __private REAL_T* restrict zimg,\n"
+           << "    const REAL_T zlen_sqr,\n"
+           << "    const REAL_T power,\n"
+           << "    const REAL_T real,\n"
+           << "    const REAL_T img\n"
+           << ")\n"
+           << "{\n"
+           << "    REAL_T base_real = *zreal;\n"
+           << "    REAL_T base_img = *zimg;\n"
+           << "    REAL_T result_real;\n"
+           << "    REAL_T result_img;\n";
+    bool result_initialized = false;
+    for (int remaining = power; remaining > 0; remaining >>= 1) {
+        if (remaining & 1) {
+            if (result_initialized) {
+                // result *= base
+                stream << "    {\n"
+                       << "        REAL_T temp = result_real * base_real - result_img * base_img;\n"
+                       << "        result_img = result_real * base_img + result_img * base_real;\n"
+                       << "        result_real = temp;\n"
+                       << "    }\n";
+            } else {
+                stream << "    result_real = base_real;\n"
+                       << "    result_img = base_img;\n";
+                result_initialized = true;
+            }
+        }
+        if (remaining > 1) {
+            // base *= base
+            stream << "    {\n"
+                   << "        REAL_T temp = base_real * base_real - base_img * base_img;\n"
+                   << "        base_img = 2 * base_real * base_img;\n"
+                   << "        base_real = temp;\n"
+                   << "    }\n";
+        }
+    }
+    stream << "    *zreal = result_real + real;\n"
+           << "    *zimg = result_img + img;\n"
+           << "}\n";
+    return stream.str();
+}
+
 template <typename T>
 struct TempValueConstants {
     static const char* opencl_type_name;
@@ -239,31 +323,67 @@ const int ResultTypeConstants<cl_ushort4>::result_max_val = CL_USHRT_MAX;
 const bool ResultTypeConstants<cl_ushort4>::color_enabled = true;
 }  // namespace
 
+bool HasSpecializedPowerFunction(double power) {
+    return kFixedPowerFunctions.count(power) != 0 || IsGeneratedPower(power);
+}
+
 template <typename T, typename P>
 MultibrotOpenClCalculator<T, P>::MultibrotOpenClCalculator(
     const boost::compute::device& device, const boost::compute::context& context,
-    size_t max_width_pix, size_t max_height_pix)
+    size_t max_width_pix, size_t max_height_pix, const MultibrotKernelOptions& kernel_options)
     : device_(device),
       context_(context),
       queue_(context, device, boost::compute::command_queue::enable_profiling),
       max_width_pix_(max_width_pix),
       max_height_pix_(max_height_pix),
-      output_device_vector_(max_width_pix * max_height_pix, context) {
-    BuildKernels();
+      kernel_options_(kernel_options),
+      output_device_vector_(max_width_pix * max_height_pix, context) {}
+
+template <typename T, typename P>
+void MultibrotOpenClCalculator<T, P>::PrepareKernel(double power, int max_iterations) {
+    EXCEPTION_ASSERT(max_iterations <= ResultTypeConstants<P>::result_max_val);
+    GetKernel(power, max_iterations);
 }
 
 template <typename T, typename P>
-std::string MultibrotOpenClCalculator<T, P>::PrepareCompilerOptions(const std::string& power_func) {
+std::string MultibrotOpenClCalculator<T, P>::PrepareCompilerOptions(
+    const std::string& power_func, int fixed_max_iterations) {
     return (boost::format("-Werror -DREAL_T=%1% -DRESULT_T=%2% -DRESULT_MAX=%3% "
-                          "-DPOWER_FUNC=%4% %5% ") %
+                          "-DPOWER_FUNC=%4% %5% %6%") %
             TempValueConstants<T>::opencl_type_name % ResultTypeConstants<P>::result_type_name %
             ResultTypeConstants<P>::result_max_val_macro % power_func %
-            (ResultTypeConstants<P>::color_enabled ? "-DCOLOR_ENABLED" : ""))
+            (ResultTypeConstants<P>::color_enabled ? "-DCOLOR_ENABLED" : "") %
+            (fixed_max_iterations > 0
+                 ? "-DFIXED_MAX_ITER_NUMBER=" + std::to_string(fixed_max_iterations)
+                 : std::string()))
         .str();
 }
 
 template <typename T, typename P>
-void MultibrotOpenClCalculator<T, P>::BuildKernels() {
+std::string MultibrotOpenClCalculator<T, P>::SelectPowerFunction(double power) const {
+    if (kernel_options_.specialize_integer_powers) {
+        auto fixed_iter = kFixedPowerFunctions.find(power);
+        if (fixed_iter != kFixedPowerFunctions.end()) {
+            return fixed_iter->second;
+        }
+        if (IsGeneratedPower(power)) {
+            return GeneratedPowerFunctionName(static_cast<int>(power));
+        }
+    }
+    return "UniversalPowerOfComplex";
+}
+
+template <typename T, typename P>
+boost::compute::kernel& MultibrotOpenClCalculator<T, P>::GetKernel(
+    double power, int max_iterations) {
+    const std::string power_func = SelectPowerFunction(power);
+    const int fixed_max_iterations = kernel_options_.fixed_max_iterations ? max_iterations : 0;
+    const KernelKey key{power_func, fixed_max_iterations};
+    auto kernel_iter = kernels_.find(key);
+    if (kernel_iter != kernels_.end()) {
+        return kernel_iter->second;
+    }
+
     // Collecting required extensions
     std::string required_extension = TempValueConstants<T>::required_extension;
     std::vector<std::string> extensions;
@@ -271,22 +391,17 @@ void MultibrotOpenClCalculator<T, P>::BuildKernels() {
         extensions.push_back(required_extension);
     }
 
-    static const std::unordered_map<double /* power */, std::string> kFixedPowerFunctions = {
-        {1.0, "Power1OfComplex"},
-        {2.0, "SquareOfComplex"},
-        {3.0, "CubeOfComplex"},
-    };
-
-    for (const auto& d : kFixedPowerFunctions) {
-        specialized_kernels_.emplace(
-            d.first, Utils::BuildKernel(
-                         "MultibrotSetKernel", context_, kMainProgram,
-                         PrepareCompilerOptions(d.second), extensions));
+    std::string source = kMainProgram;
+    if (kernel_options_.specialize_integer_powers && IsGeneratedPower(power)) {
+        source = Utils::CombineStrings({GeneratePowerFunction(static_cast<int>(power)), source});
     }
 
-    universal_kernel_ = Utils::BuildKernel(
-        "MultibrotSetKernel", context_, kMainProgram,
-        PrepareCompilerOptions("UniversalPowerOfComplex"), extensions);
+    return kernels_
+        .emplace(
+            key, Utils::BuildKernel(
+                     "MultibrotSetKernel", context_, source,
+                     PrepareCompilerOptions(power_func, fixed_max_iterations), extensions))
+        .first->second;
 }
 
 template <typename T, typename P>
@@ -4,10 +4,27 @@
 #include <utils/utils.h>  // TODO split that header to move EXCEPTION_ASSERT to smaller header
 
 #include <complex>
+#include <map>
 #include <memory>
 
 #include "boost/compute.hpp"
 
+/*
+Controls how Multibrot kernels are specialized. Every combination of options, power and
+(when fixed) max iteration number gets its own kernel, built on first use and cached.
+*/
+struct MultibrotKernelOptions {
+    // Use power functions generated for integer powers (unrolled binary exponentiation)
+    // instead of the universal one based on powr/atan2/cos/sin
+    bool specialize_integer_powers = true;
+    // Build max iteration number into a kernel as a compile-time constant
+    bool fixed_max_iterations = false;
+};
+
+// Checks if specialize_integer_powers changes a kernel for a given power, other powers are
+// always calculated by the universal function
+bool HasSpecializedPowerFunction(double power);
+
 // TODO add support for color and grayscale result, both 8 and 16 bit
 // may be even floating point pixel formal
 // T is temporary value type (must be a floating pointing type)
@@ -17,7 +34,13 @@ class MultibrotOpenClCalculator {
 public:
     MultibrotOpenClCalculator(
         const boost::compute::device& device, const boost::compute::context& context,
-        size_t max_width_pix, size_t max_height_pix);
+        size_t max_width_pix, size_t max_height_pix,
+        const MultibrotKernelOptions& kernel_options = MultibrotKernelOptions());
+
+    // Build a kernel for given power and max iterations number if it is not built yet.
+    // Optional, Calculate() does it anyway, but this allows to exclude build time from
+    // the first calculation.
+    void PrepareKernel(double power, int max_iterations);
 
     // Calculate the given region of Multibrot set.
     // This method only enqueues commands, result will be written to output_iter.
@@ -51,11 +74,7 @@ public:
 
         // TODO we could use set_arg() overload for fundamental types for float and double
         // types that is easier to use, but have to add a custom overload for half and its vectors
-        boost::compute::kernel& kernel = universal_kernel_;
-        auto kernel_iter = specialized_kernels_.find(power);
-        if (kernel_iter != specialized_kernels_.end()) {
-            kernel = kernel_iter->second;
-        }
+        boost::compute::kernel& kernel = GetKernel(power, max_iterations);
 
         kernel.set_arg(0, sizeof(T), &input_min_conv);
         kernel.set_arg(1, sizeof(T), reinterpret_cast<T(&)[2]>(input_min_conv) + 1);
@@ -84,8 +103,13 @@ public:
     }
 
 private:
-    void BuildKernels();
-    std::string PrepareCompilerOptions(const std::string& power_func);
+    // Kernels are identified by a name of power function and fixed max iteration number
+    // (zero if it is not fixed)
+    typedef std::pair<std::string, int> KernelKey;
+
+    boost::compute::kernel& GetKernel(double power, int max_iterations);
+    std::string SelectPowerFunction(double power) const;
+    std::string PrepareCompilerOptions(const std::string& power_func, int fixed_max_iterations);
     void ExecutePrecalculateChecks(size_t width_pix, size_t height_pix, int max_iterations);
 
     boost::compute::device device_;
@@ -94,8 +118,8 @@ private:
     size_t max_width_pix_;
     size_t max_height_pix_;
     int pixel_bit_depth_;
-    std::unordered_map<double /* power */, boost::compute::kernel> specialized_kernels_;
-    boost::compute::kernel universal_kernel_;
+    MultibrotKernelOptions kernel_options_;
+    std::map<KernelKey, boost::compute::kernel> kernels_;
     boost::compute::vector<P> output_device_vector_;
     boost::compute::event prev_event_;
 };
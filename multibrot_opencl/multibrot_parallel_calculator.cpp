@@ -12,7 +12,8 @@ const Duration MultibrotParallelCalculator<P>::target_execution_time_ =
     Duration(std::chrono::seconds(1));
 
 template <typename P>
-MultibrotParallelCalculator<P>::MultibrotParallelCalculator(size_t width_pix, size_t height_pix)
+MultibrotParallelCalculator<P>::MultibrotParallelCalculator(
+    size_t width_pix, size_t height_pix, const MultibrotKernelOptions& kernel_options)
     : partitioner_(width_pix, height_pix, fragment_width_pix_, fragment_height_pix_),
       width_pix_(width_pix),
       height_pix_(height_pix) {
@@ -48,7 +49,7 @@ MultibrotParallelCalculator<P>::MultibrotParallelCalculator(size_t width_pix, si
 
     for (auto& device : devices) {
         // TODO implement automatic resizing of memory buffers?
-        device_states_.emplace(device, DeviceState(device));
+        device_states_.emplace(device, DeviceState(device, kernel_options));
     }
 }
 
@@ -64,8 +65,12 @@ std::complex<double> MultibrotParallelCalculator<P>::CalcComplexVal(
 template <typename P>
 void MultibrotParallelCalculator<P>::Calculate(
     std::complex<double> input_min, std::complex<double> input_max, double power,
-    int max_iterations, Callback cb) {
+    int max_iterations, Callback cb,
+    const std::vector<ImagePartitioner::Segment>& completed_segments) {
     partitioner_.Reset();
+    for (const ImagePartitioner::Segment& segment : completed_segments) {
+        partitioner_.MarkCompleted(segment);
+    }
 
     CalculateFirstPhase(input_min, input_max, power, max_iterations, cb);
 
@@ -29,12 +29,17 @@ public:
     typedef std::function<void(
         const boost::compute::device&, const ImagePartitioner::Segment&, const ResultType*)>
         Callback;
-    MultibrotParallelCalculator(size_t width_pix, size_t height_pix);
+    MultibrotParallelCalculator(
+        size_t width_pix, size_t height_pix,
+        const MultibrotKernelOptions& kernel_options = MultibrotKernelOptions());
 
     // TODO how callback should be provided, by value or reference?
+    // Segments in completed_segments are not calculated again, callback is not called for them.
     void Calculate(
         std::complex<double> input_min, std::complex<double> input_max, double power,
-        int max_iterations, Callback cb);
+        int max_iterations, Callback cb,
+        const std::vector<ImagePartitioner::Segment>& completed_segments =
+            std::vector<ImagePartitioner::Segment>());
 
 private:
     typedef float TempValueType;
@@ -53,10 +58,11 @@ private:
         size_t processed_pixels = 0;
         boost::optional<PrevOperationInfo> prev_operation_info;
 
-        DeviceState(const boost::compute::device& device)
+        DeviceState(
+            const boost::compute::device& device, const MultibrotKernelOptions& kernel_options)
             : calculator(
                   device, boost::compute::context{device}, max_segment_width_pix_,
-                  max_segment_height_pix_),
+                  max_segment_height_pix_, kernel_options),
               output_vector(max_segment_width_pix_ * max_segment_height_pix_) {}
     };
 
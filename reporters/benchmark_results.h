@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -12,6 +13,8 @@
 struct FixtureBenchmark {
     std::vector<std::unordered_map<std::string, Duration>> durations;
     boost::optional<std::string> failure_reason;
+    // Fixture::ExecutionMetrics() after the last iteration
+    std::unordered_map<std::string, double> metrics;
 };
 
 struct FixtureFamilyBenchmark {
@@ -1,7 +1,14 @@
 #pragma once
 
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
 #include "devices/platform_list.h"
 #include "indicators/duration_indicator.h"
+#include "indicators/scaling_indicator.h"
+#include "iterators/random_values_iterator.h"
 #include "nlohmann/json.hpp"
 #include "reporters/benchmark_reporter.h"
 
@@ -14,7 +21,8 @@ public:
     void Initialize(const PlatformList& platform_list) override {
         tree_["baseInfo"] = {{"about", "This file was built by OpenCL benchmark."},
                              {"time", GetCurrentTimeString()},
-                             {"formatVersion", "0.1.0"}};
+                             {"formatVersion", "0.1.0"},
+                             {"randomSeed", GetDefaultRandomSeed()}};
         for (auto& platform : platform_list.AllPlatforms()) {
             nlohmann::json devices = nlohmann::json::array();
             for (auto& device : platform->GetDevices()) {
@@ -34,20 +42,41 @@ public:
         }
 
         json fixture_tree = json::array();
+        // Device unique name -> (algorithm, duration) for all successful fixtures
+        std::map<std::string, std::vector<std::pair<std::string, Duration>>> device_durations;
         for (auto& data : results.benchmark) {
             DurationIndicator indicator{data.second};
+            if (!indicator.IsEmpty() && !data.second.failure_reason) {
+                device_durations[data.first.device()->UniqueName()].push_back(
+                    {data.first.algorithm(), indicator.TotalDuration()});
+            }
             json current_fixture_tree = json::object({{"name", data.first.Serialize()}});
 
             if (!indicator.IsEmpty()) {
                 indicator.SerializeValue(current_fixture_tree);
             }
+            if (!data.second.metrics.empty()) {
+                current_fixture_tree["metrics"] = data.second.metrics;
+            }
             if (data.second.failure_reason) {
                 current_fixture_tree["failureReason"] = data.second.failure_reason.value();
             }
             fixture_tree.push_back(current_fixture_tree);
+
+            if (results.fixture_family->sweep_name && results.fixture_family->element_count &&
+                !indicator.IsEmpty()) {
+                sweeps_[results.fixture_family->sweep_name.value()][data.first.Serialize()]
+                    .push_back(
+                        {results.fixture_family->element_count.value(),
+                         indicator.StepMinDurations()});
+            }
         }
 
         fixture_family_tree["fixtures"] = fixture_tree;
+        if (results.fixture_family->algorithms.size() > 1) {
+            fixture_family_tree["algorithmComparison"] =
+                CompareAlgorithms(results.fixture_family->algorithms, device_durations);
+        }
         tree_["fixtureFamilies"].push_back(fixture_family_tree);
     }
 
@@ -55,6 +84,7 @@ public:
     Optional method to flush all contents to output
     */
     void Flush() override {
+        SerializeSweeps();
         try {
             std::ofstream o(file_name_);
             o.exceptions(std::ios_base::badbit | std::ios_base::failbit | std::ios_base::eofbit);
@@ -71,6 +101,73 @@ public:
     }
 
 private:
+    /*
+    Ranks algorithms of every device from the fastest to the slowest one. Speedup is relative
+    to the baseline algorithm (the first one of a family), or to the slowest algorithm if
+    the baseline has failed on a device.
+    */
+    nlohmann::json CompareAlgorithms(
+        const std::vector<std::string>& algorithms,
+        std::map<std::string, std::vector<std::pair<std::string, Duration>>>& device_durations) {
+        using nlohmann::json;
+
+        json comparison_tree = json::array();
+        for (auto& device_data : device_durations) {
+            auto& durations = device_data.second;
+            if (durations.size() < 2) {
+                continue;
+            }
+            std::sort(
+                durations.begin(), durations.end(),
+                [](const std::pair<std::string, Duration>& lhs,
+                   const std::pair<std::string, Duration>& rhs) {
+                    return lhs.second < rhs.second;
+                });
+            auto baseline = std::find_if(
+                durations.cbegin(), durations.cend(),
+                [&](const std::pair<std::string, Duration>& d) {
+                    return d.first == algorithms.front();
+                });
+            if (baseline == durations.cend()) {
+                baseline = durations.cend() - 1;
+            }
+
+            json ranking_tree = json::array();
+            for (const auto& d : durations) {
+                ranking_tree.push_back(
+                    {{"algorithm", d.first},
+                     {"duration", d.second},
+                     {"speedup", baseline->second / d.second}});
+            }
+            comparison_tree.push_back(
+                {{"device", device_data.first},
+                 {"baselineAlgorithm", baseline->first},
+                 {"ranking", ranking_tree}});
+        }
+        return comparison_tree;
+    }
+
+    // Fits durations of every fixture of a sweep against element count
+    void SerializeSweeps() {
+        using nlohmann::json;
+
+        json sweeps_tree = json::array();
+        for (auto& sweep : sweeps_) {
+            json fixture_tree = json::array();
+            for (auto& fixture_points : sweep.second) {
+                ScalingIndicator indicator{fixture_points.second};
+                if (indicator.IsEmpty()) {
+                    continue;
+                }
+                json current_fixture_tree = json::object({{"name", fixture_points.first}});
+                indicator.SerializeValue(current_fixture_tree);
+                fixture_tree.push_back(current_fixture_tree);
+            }
+            sweeps_tree.push_back({{"name", sweep.first}, {"fixtures", fixture_tree}});
+        }
+        tree_["sweeps"] = sweeps_tree;
+    }
+
     // TODO move to some free function?
     std::string GetCurrentTimeString() {
         // TODO replace with some library?
@@ -87,6 +184,8 @@ private:
     static const bool pretty_ = true;  // TODO make configurable?
     std::string file_name_;
     nlohmann::json tree_;
+    // Sweep name -> serialized fixture id -> durations for every element count
+    std::map<std::string, std::map<std::string, std::vector<ScalingIndicator::Point>>> sweeps_;
 };
 
 }  // namespace kpv
@@ -1,9 +1,12 @@
 #ifndef KPV_RUN_SETTINGS_H_
 #define KPV_RUN_SETTINGS_H_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
+#include "boost/optional.hpp"
+
 #include "utils/duration.h"
 
 namespace kpv {
@@ -31,6 +34,8 @@ struct RunSettings {
     std::string additional_params;
     enum Operation { kList, kRunAllExcept, kRunOnly } operation;
     DeviceConfiguration device_config = DeviceConfiguration(true);
+    // Seed of random input data, a random one is used if it is not set
+    boost::optional<uint64_t> random_seed;
 };
 
 }  // namespace kpv
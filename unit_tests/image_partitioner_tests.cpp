@@ -0,0 +1,126 @@
+#include <array>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "catch/single_include/catch.hpp"
+#include "multibrot_console/render_journal.h"
+#include "multibrot_opencl/image_partitioner.h"
+
+namespace {
+// x, y, width and height of a segment
+typedef std::array<size_t, 4> SegmentCoords;
+
+ImagePartitioner::Segment MakeSegment(size_t x, size_t y, size_t width_pix, size_t height_pix) {
+    ImagePartitioner::Segment segment;
+    segment.x = x;
+    segment.y = y;
+    segment.width_pix = width_pix;
+    segment.height_pix = height_pix;
+    return segment;
+}
+
+// Segments returned by Partition() until the whole area is assigned, in the returned order
+std::vector<SegmentCoords> PartitionAll(
+    ImagePartitioner& partitioner, size_t preferred_fragment_count) {
+    std::vector<SegmentCoords> result;
+    while (true) {
+        const ImagePartitioner::Segment segment = partitioner.Partition(preferred_fragment_count);
+        if (segment.IsEmpty()) {
+            return result;
+        }
+        result.push_back({segment.x, segment.y, segment.width_pix, segment.height_pix});
+    }
+}
+}  // namespace
+
+// Area is 8x4 pixels, fragments are 2x2 pixels: two rows of four fragments
+TEST_CASE("ImagePartitioner skips completed segments", "[Image partitioner tests]") {
+    ImagePartitioner partitioner(8, 4, 2, 2);
+
+    SECTION("Nothing is completed") {
+        const std::vector<SegmentCoords> expected = {
+            {0, 0, 2, 2}, {2, 0, 2, 2}, {4, 0, 2, 2}, {6, 0, 2, 2},
+            {0, 2, 2, 2}, {2, 2, 2, 2}, {4, 2, 2, 2}, {6, 2, 2, 2}};
+        CHECK(PartitionAll(partitioner, 1) == expected);
+    }
+    SECTION("Exactly completed segments are skipped, order is kept") {
+        partitioner.MarkCompleted(MakeSegment(2, 0, 2, 2));
+        partitioner.MarkCompleted(MakeSegment(4, 2, 4, 2));
+        const std::vector<SegmentCoords> expected = {
+            {0, 0, 2, 2}, {4, 0, 2, 2}, {6, 0, 2, 2}, {0, 2, 2, 2}, {2, 2, 2, 2}};
+        CHECK(PartitionAll(partitioner, 1) == expected);
+    }
+    SECTION("Segments stop before completed ones") {
+        partitioner.MarkCompleted(MakeSegment(2, 0, 2, 2));
+        partitioner.MarkCompleted(MakeSegment(4, 2, 4, 2));
+        const std::vector<SegmentCoords> expected = {{0, 0, 2, 2}, {4, 0, 4, 2}, {0, 2, 4, 2}};
+        CHECK(PartitionAll(partitioner, 4) == expected);
+    }
+    SECTION("Fully completed area has nothing to partition") {
+        partitioner.MarkCompleted(MakeSegment(0, 0, 8, 2));
+        partitioner.MarkCompleted(MakeSegment(0, 2, 8, 2));
+        CHECK(PartitionAll(partitioner, 1).empty());
+    }
+    SECTION("Empty segments are ignored") {
+        partitioner.MarkCompleted(MakeSegment(0, 0, 0, 2));
+        partitioner.MarkCompleted(MakeSegment(2, 2, 2, 0));
+        const std::vector<SegmentCoords> expected = {{0, 0, 8, 2}, {0, 2, 8, 2}};
+        CHECK(PartitionAll(partitioner, 4) == expected);
+    }
+    SECTION("Segments which don't fit partitioning are rejected") {
+        CHECK_THROWS_AS(partitioner.MarkCompleted(MakeSegment(0, 1, 2, 2)), std::invalid_argument);
+        CHECK_THROWS_AS(partitioner.MarkCompleted(MakeSegment(6, 0, 4, 2)), std::invalid_argument);
+    }
+    SECTION("Reset forgets completed segments") {
+        partitioner.MarkCompleted(MakeSegment(0, 0, 8, 2));
+        partitioner.Reset();
+        const std::vector<SegmentCoords> expected = {{0, 0, 8, 2}, {0, 2, 8, 2}};
+        CHECK(PartitionAll(partitioner, 4) == expected);
+    }
+}
+
+TEST_CASE("Partially completed render journal is resumed", "[Image partitioner tests]") {
+    const boost::filesystem::path folder =
+        boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    boost::filesystem::create_directories(folder);
+    const boost::filesystem::path journal_path = folder / "journal.txt";
+    const std::string description = "8x4 test render";
+    {
+        std::ofstream stream(journal_path.string());
+        stream << description << "\n";
+        stream << "4 2 4 2 segment_4_2.png\n";
+        // File of this entry is missing, so the segment is calculated again
+        stream << "0 2 2 2 missing.png\n";
+        stream << "2 0 2 2 segment_2_0.png\n";
+        // Incomplete line, the program was interrupted while writing it
+        stream << "6 0 2 2 segm";
+    }
+    std::ofstream((folder / "segment_4_2.png").string());
+    std::ofstream((folder / "segment_2_0.png").string());
+    std::ofstream((folder / "segm").string());
+
+    std::vector<ImagePartitioner::Segment> completed_segments;
+    {
+        RenderJournal journal(journal_path, description, true);
+        completed_segments = journal.CompletedSegments();
+    }
+    boost::filesystem::remove_all(folder);
+
+    // Entries are kept in journal order
+    REQUIRE(completed_segments.size() == 2);
+    CHECK(completed_segments[0].x == 4);
+    CHECK(completed_segments[0].y == 2);
+    CHECK(completed_segments[1].x == 2);
+    CHECK(completed_segments[1].y == 0);
+
+    ImagePartitioner partitioner(8, 4, 2, 2);
+    for (const ImagePartitioner::Segment& segment : completed_segments) {
+        partitioner.MarkCompleted(segment);
+    }
+    const std::vector<SegmentCoords> expected = {
+        {0, 0, 2, 2}, {4, 0, 2, 2}, {6, 0, 2, 2}, {0, 2, 2, 2}, {2, 2, 2, 2}};
+    CHECK(PartitionAll(partitioner, 1) == expected);
+}
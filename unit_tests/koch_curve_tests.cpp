@@ -75,9 +75,9 @@ TEST_CASE("CalcLinesNumberForIteration works correctly", "[Koch curve tests]") {
 }
 
 TEST_CASE("CalcGlobalId works correctly", "[Koch curve tests]") {
-    std::vector<cl_int2> input_values = {{0, 0}, {1, 0}, {1, 1},  {1, 2}, {1, 3},
-                                         {2, 0}, {2, 7}, {2, 15}, {3, 0}};
-    std::vector<int32_t> expected_output = {0, 1, 2, 3, 4, 5, 12, 20, 21};
+    std::vector<cl_int2> input_values = {{0, 0}, {1, 0}, {1, 1},  {1, 2}, {1, 3},  {2, 0},
+                                         {2, 7}, {2, 15}, {3, 0}, {5, 3}, {10, 0}, {10, 5}};
+    std::vector<int32_t> expected_output = {0, 1, 2, 3, 4, 5, 12, 20, 21, 344, 349525, 349530};
 
     REQUIRE(input_values.size() == expected_output.size());
     // get default device and setup context
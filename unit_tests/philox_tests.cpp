@@ -0,0 +1,33 @@
+#include <vector>
+
+#include "catch/single_include/catch.hpp"
+#include "philox.h"
+
+// Known answers are taken from Random123 library (kat_vectors file)
+TEST_CASE("Philox4x32-10 produces known answers", "[Philox tests]") {
+    CHECK(
+        Philox4x32::Generate({0, 0, 0, 0}, {0, 0}) ==
+        Philox4x32::Counter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8});
+    CHECK(
+        Philox4x32::Generate(
+            {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff}) ==
+        Philox4x32::Counter{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd});
+    CHECK(
+        Philox4x32::Generate(
+            {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0}) ==
+        Philox4x32::Counter{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1});
+}
+
+TEST_CASE("Philox4x32 streams are reproducible", "[Philox tests]") {
+    Philox4x32 first(12345, 7);
+    Philox4x32 second(12345, 7);
+    Philox4x32 other_stream(12345, 8);
+    std::vector<uint32_t> first_values, second_values, other_values;
+    for (int i = 0; i < 10; ++i) {
+        first_values.push_back(first());
+        second_values.push_back(second());
+        other_values.push_back(other_stream());
+    }
+    CHECK(first_values == second_values);
+    CHECK(first_values != other_values);
+}
@@ -0,0 +1,142 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string>
+
+#include "catch/single_include/catch.hpp"
+#include "documents/svg_document.h"
+
+namespace {
+const char* const kFileName = "svg_document_tests.svg";
+
+std::string ReadAndRemoveDocument() {
+    std::string content;
+    {
+        std::ifstream stream(kFileName);
+        content.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    }
+    std::remove(kFileName);
+    return content;
+}
+
+// Text of x1 attribute of a line element that starts at (v, 0)
+template <typename T>
+std::string FormatValue(T v) {
+    {
+        SvgDocument document(kFileName, 1.0, 1.0);
+        document.AddLine(v, T(0), T(0), T(0));
+    }
+    const std::string content = ReadAndRemoveDocument();
+    const std::string prefix = "<line x1=\"";
+    const size_t begin = content.find(prefix);
+    REQUIRE(begin != std::string::npos);
+    const size_t end = content.find('"', begin + prefix.size());
+    REQUIRE(end != std::string::npos);
+    return content.substr(begin + prefix.size(), end - begin - prefix.size());
+}
+
+int CountSignificantDigits(const std::string& str) {
+    int count = 0;
+    bool leading_zeros = true;
+    for (char c : str) {
+        if (c == 'e') {
+            break;
+        }
+        if (c >= '1' && c <= '9') {
+            leading_zeros = false;
+        }
+        if (c >= '0' && c <= '9' && !leading_zeros) {
+            ++count;
+        }
+    }
+    return count;
+}
+}  // namespace
+
+TEST_CASE("SvgDocument writes zero", "[SVG document tests]") {
+    CHECK(FormatValue(0.0) == "0");
+    CHECK(FormatValue(0.0f) == "0");
+}
+
+TEST_CASE("SvgDocument writes small values in scientific notation", "[SVG document tests]") {
+    CHECK(FormatValue(1e-5) == "0.00001");
+    CHECK(FormatValue(1.5e-5) == "0.000015");
+    CHECK(FormatValue(9.5e-6) == "9.5e-6");
+    CHECK(FormatValue(1e-6) == "1e-6");
+    CHECK(FormatValue(-1.2345e-7) == "-1.2345e-7");
+    CHECK(FormatValue(1e-6f) == "1e-6");
+}
+
+TEST_CASE("SvgDocument writes large values in scientific notation", "[SVG document tests]") {
+    CHECK(FormatValue(1e16) == "10000000000000000");
+    CHECK(FormatValue(1e17) == "1e17");
+    CHECK(FormatValue(1.5e17) == "1.5e17");
+    CHECK(FormatValue(-1.23456789e28) == "-1.23456789e28");
+    CHECK(FormatValue(1e17f) == "1e17");
+}
+
+TEST_CASE("SvgDocument writes powers of ten and their neighbours", "[SVG document tests]") {
+    const char* const expected[] = {"0.00001", "0.0001", "0.001", "0.01", "0.1",
+                                    "1",       "10",     "100",   "1000", "10000"};
+    for (int exponent = -5; exponent <= 4; ++exponent) {
+        const double power = std::pow(10.0, exponent);
+        CHECK(FormatValue(power) == expected[exponent + 5]);
+
+        // The closest values differ in the last bit, they are written with enough digits
+        // to be parsed back exactly
+        for (double v : {std::nextafter(power, 0.0), std::nextafter(power, 2 * power)}) {
+            const std::string str = FormatValue(v);
+            CHECK(std::strtod(str.c_str(), nullptr) == v);
+            CHECK(CountSignificantDigits(str) <= std::numeric_limits<double>::max_digits10);
+        }
+    }
+}
+
+TEST_CASE("SvgDocument writes float and double in the shortest form", "[SVG document tests]") {
+    CHECK(FormatValue(0.1f) == "0.1");
+    CHECK(FormatValue(0.1) == "0.1");
+    CHECK(FormatValue(1.0f / 3) == "0.33333334");
+    CHECK(FormatValue(1.0 / 3) == "0.3333333333333333");
+    CHECK(FormatValue(16777216.0f) == "16777216");
+    CHECK(FormatValue(-1234.5) == "-1234.5");
+}
+
+TEST_CASE("SvgDocument writes subnormal doubles with all digits", "[SVG document tests]") {
+    const double v = std::numeric_limits<double>::denorm_min();
+    const std::string str = FormatValue(v);
+    CHECK(str == "4.9406564584124654e-324");
+    CHECK(std::strtod(str.c_str(), nullptr) == v);
+}
+
+TEST_CASE("SvgDocument starts a new subpath for a disconnected line", "[SVG document tests]") {
+    {
+        SvgDocument document(kFileName, 10.0, 10.0, true);
+        document.AddLine(0.0, 0.0, 1.0, 0.0);
+        document.AddLine(1.0, 0.0, 1.0, 1.0);
+        document.AddLine(2.0, 2.0, 3.0, 3.0);
+        document.AddLine(3.0, 3.0, 4.0, 3.5);
+    }
+    const std::string content = ReadAndRemoveDocument();
+    CHECK(content.find("<path d=\"M 0 0 1 0 1 1 M 2 2 3 3 4 3.5\"/>") != std::string::npos);
+    CHECK(content.find("<line") == std::string::npos);
+}
+
+TEST_CASE("SvgDocument splits long polylines into several paths", "[SVG document tests]") {
+    {
+        SvgDocument document(kFileName, 10.0, 10.0, true);
+        // 10000 connected lines have 10001 points, one more than a path may contain
+        for (int i = 0; i < 10000; ++i) {
+            document.AddLine(static_cast<double>(i), 0.0, static_cast<double>(i + 1), 0.0);
+        }
+    }
+    const std::string content = ReadAndRemoveDocument();
+    const size_t first_path = content.find("<path d=\"M 0 0 ");
+    REQUIRE(first_path != std::string::npos);
+    // The second path starts where the first one ended
+    const size_t second_path = content.find("<path d=\"M 9999 0 10000 0\"/>");
+    CHECK(second_path != std::string::npos);
+    CHECK(content.find("<path", first_path + 1) == second_path);
+}
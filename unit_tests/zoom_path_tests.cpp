@@ -0,0 +1,102 @@
+#include <complex>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "catch/single_include/catch.hpp"
+#include "multibrot_console/zoom_path.h"
+
+namespace {
+ZoomPath::Keyframe MakeKeyframe(std::complex<double> center, double scale, size_t frame_count) {
+    ZoomPath::Keyframe keyframe;
+    keyframe.center = center;
+    keyframe.scale = scale;
+    keyframe.frame_count = frame_count;
+    return keyframe;
+}
+
+// Center and scale of a frame, aspect ratio is 1
+void GetFrame(
+    const ZoomPath& path, size_t frame_index, std::complex<double>* center, double* scale) {
+    std::complex<double> min, max;
+    path.FrameRegion(frame_index, 1.0, &min, &max);
+    *center = (min + max) / 2.0;
+    *scale = max.real() - min.real();
+}
+}  // namespace
+
+TEST_CASE("ZoomPath interpolates scale geometrically", "[Zoom path tests]") {
+    ZoomPath path({MakeKeyframe({0.0, 0.0}, 16.0, 4), MakeKeyframe({0.0, 0.0}, 1.0, 0)});
+    const std::vector<double> expected_scales = {16.0, 8.0, 4.0, 2.0, 1.0};
+    REQUIRE(path.FrameCount() == expected_scales.size());
+    for (size_t i = 0; i < expected_scales.size(); ++i) {
+        std::complex<double> center;
+        double scale = 0.0;
+        GetFrame(path, i, &center, &scale);
+        CHECK(scale == Approx(expected_scales[i]));
+    }
+}
+
+TEST_CASE("ZoomPath keeps zoomed in point at the same place of a frame", "[Zoom path tests]") {
+    const std::complex<double> from_center{0.0, 0.0}, to_center{1.0, 1.0};
+    const double from_scale = 4.0, to_scale = 1.0;
+    ZoomPath path({MakeKeyframe(from_center, from_scale, 5), MakeKeyframe(to_center, to_scale, 0)});
+    // The only point which has the same position relative to both keyframes
+    const std::complex<double> fixed_point =
+        from_center + (to_center - from_center) * (from_scale / (from_scale - to_scale));
+    const std::complex<double> expected_position = (fixed_point - from_center) / from_scale;
+    for (size_t i = 0; i < path.FrameCount(); ++i) {
+        std::complex<double> center;
+        double scale = 0.0;
+        GetFrame(path, i, &center, &scale);
+        const std::complex<double> position = (fixed_point - center) / scale;
+        CHECK(position.real() == Approx(expected_position.real()));
+        CHECK(position.imag() == Approx(expected_position.imag()));
+    }
+}
+
+TEST_CASE("ZoomPath moves center linearly when scale doesn't change", "[Zoom path tests]") {
+    ZoomPath path({MakeKeyframe({0.0, 0.0}, 2.0, 4), MakeKeyframe({4.0, -8.0}, 2.0, 0)});
+    for (size_t i = 0; i < path.FrameCount(); ++i) {
+        std::complex<double> center;
+        double scale = 0.0;
+        GetFrame(path, i, &center, &scale);
+        CHECK(scale == Approx(2.0));
+        CHECK(center.real() == Approx(1.0 * i));
+        CHECK(center.imag() == Approx(-2.0 * i));
+    }
+}
+
+TEST_CASE("ZoomPath counts frames of all keyframes", "[Zoom path tests]") {
+    SECTION("Single keyframe is a single frame") {
+        ZoomPath path({MakeKeyframe({0.5, 0.5}, 1.0, 10)});
+        CHECK(path.FrameCount() == 1);
+    }
+    SECTION("Frame count of the last keyframe is ignored") {
+        ZoomPath path(
+            {MakeKeyframe({0.0, 0.0}, 4.0, 3), MakeKeyframe({0.0, 0.0}, 2.0, 5),
+             MakeKeyframe({1.0, 0.0}, 1.0, 100)});
+        REQUIRE(path.FrameCount() == 9);
+
+        // The last frame shows the last keyframe, frames after it don't exist
+        std::complex<double> center;
+        double scale = 0.0;
+        GetFrame(path, 8, &center, &scale);
+        CHECK(center.real() == Approx(1.0));
+        CHECK(scale == Approx(1.0));
+        std::complex<double> min, max;
+        CHECK_THROWS_AS(path.FrameRegion(9, 1.0, &min, &max), std::out_of_range);
+    }
+}
+
+TEST_CASE("ZoomPath rejects negative frame count in a file", "[Zoom path tests]") {
+    const std::string file_name = "zoom_path_tests_negative_frame_count.txt";
+    {
+        std::ofstream stream(file_name);
+        stream << "0 0 4 -1\n0 0 1 0\n";
+    }
+    CHECK_THROWS_AS(ZoomPath::ReadFromFile(file_name), std::runtime_error);
+    std::remove(file_name.c_str());
+}
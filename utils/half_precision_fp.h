@@ -12,3 +12,19 @@ options
 #define HALF_ROUND_STYLE std::round_to_nearest
 #define HALF_ROUND_TIES_TO_EVEN 1
 #include "half/half.hpp"
+
+/*
+Host counterparts of OpenCL half2 and half4 vector types. Unlike cl_half2 and cl_half4, which
+contain raw bits, their elements support arithmetic. Size and alignment are the same as of
+OpenCL vectors, so they can be copied to and from device buffers as is.
+*/
+struct alignas(4) Half2 {
+    half_float::half x, y;
+};
+
+struct alignas(8) Half4 {
+    half_float::half x, y, z, w;
+};
+
+static_assert(sizeof(Half2) == 4, "Half2 must have the same size as OpenCL half2");
+static_assert(sizeof(Half4) == 8, "Half4 must have the same size as OpenCL half4");
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+/*
+Philox4x32-10 counter-based random number generator (J. K. Salmon et al., "Parallel Random
+Numbers: As Easy as 1, 2, 3"). Every block of 4 values is a function of a counter and a key
+only, so any part of a sequence can be generated independently, e.g. by many threads.
+
+An engine is a stream given by a key (seed) and a stream index (e.g. an index of an element
+that is generated from this stream). It satisfies UniformRandomBitGenerator requirements,
+so it can be used with standard distributions.
+*/
+class Philox4x32 {
+public:
+    typedef uint32_t result_type;
+    typedef std::array<uint32_t, 4> Counter;
+    typedef std::array<uint32_t, 2> Key;
+
+    Philox4x32(uint64_t seed, uint64_t stream_index)
+        : key_({static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)}),
+          counter_(
+              {0, 0, static_cast<uint32_t>(stream_index),
+               static_cast<uint32_t>(stream_index >> 32)}) {}
+
+    static constexpr result_type min() { return std::numeric_limits<result_type>::min(); }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        if (index_ == block_.size()) {
+            block_ = Generate(counter_, key_);
+            // 64-bit block number in two lower counter words
+            if (++counter_[0] == 0) {
+                ++counter_[1];
+            }
+            index_ = 0;
+        }
+        return block_[index_++];
+    }
+
+    // Calculates a block of random values for a given counter and key
+    static Counter Generate(Counter counter, Key key) {
+        for (int round = 0; round < 10; ++round) {
+            if (round > 0) {
+                key[0] += kWeyl0;
+                key[1] += kWeyl1;
+            }
+            const uint64_t product0 = static_cast<uint64_t>(kMultiplier0) * counter[0];
+            const uint64_t product1 = static_cast<uint64_t>(kMultiplier1) * counter[2];
+            counter = {static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+                       static_cast<uint32_t>(product1),
+                       static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+                       static_cast<uint32_t>(product0)};
+        }
+        return counter;
+    }
+
+private:
+    static constexpr uint32_t kMultiplier0 = 0xD2511F53;
+    static constexpr uint32_t kMultiplier1 = 0xCD9E8D57;
+    static constexpr uint32_t kWeyl0 = 0x9E3779B9;
+    static constexpr uint32_t kWeyl1 = 0xBB67AE85;
+
+    Key key_;
+    Counter counter_;
+    Counter block_ = {};
+    size_t index_ = 4;
+};
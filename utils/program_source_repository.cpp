@@ -34,13 +34,8 @@ int CalcLinesNumberForIteration(int iterationCount)
 // TODO for invalid values report error in some way or return 0?
 int CalcGlobalId(int2 ids)
 {
-    int result = ids.y;
-    // TODO this function can be optimized by caching these values
-    for (int iterationNumber = 0; iterationNumber < ids.x; ++iterationNumber)
-    {
-        result += CalcLinesNumberForIteration(iterationNumber);
-    }
-    return result;
+    // Number of lines on all previous iterations is 4^0 + 4^1 + ... + 4^(n-1) = (4^n-1)/3
+    return (CalcLinesNumberForIteration(ids.x) - 1) / 3 + ids.y;
 }
 )";
 
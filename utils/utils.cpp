@@ -157,4 +157,13 @@ std::unordered_map<std::string, Duration> GetOpenCLEventDurations(
     }
     return result;
 }
+
+std::unordered_map<std::string, Duration> GetOpenCLEventDurations(
+    const std::unordered_multimap<std::string, boost::compute::event>& events) {
+    std::unordered_map<std::string, Duration> result;
+    for (const std::pair<std::string, boost::compute::event>& p : events) {
+        result[p.first] += Duration(p.second);
+    }
+    return result;
+}
 }  // namespace Utils
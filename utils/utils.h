@@ -137,6 +137,10 @@ boost::compute::program BuildProgram(
 std::unordered_map<std::string, Duration> GetOpenCLEventDurations(
     const std::unordered_map<std::string, boost::compute::event>& events);
 
+// Same as above, but a step may consist of several events, their durations are summed
+std::unordered_map<std::string, Duration> GetOpenCLEventDurations(
+    const std::unordered_multimap<std::string, boost::compute::event>& events);
+
 std::string CombineStrings(
     const std::vector<std::string>& strings, const std::string& delimiter = "\n");
 
@@ -164,6 +168,15 @@ T4 StaticCastVector4(const U4& v) {
                static_cast<float>(v.s[3])});
 }
 
+// Elements of half vectors can't be implicitly constructed from float, round them directly
+template <>
+inline Half4 StaticCastVector4<Half4, cl_double4>(const cl_double4& v) {
+    return {half_float::half_cast<half_float::half>(v.s[0]),
+            half_float::half_cast<half_float::half>(v.s[1]),
+            half_float::half_cast<half_float::half>(v.s[2]),
+            half_float::half_cast<half_float::half>(v.s[3])};
+}
+
 cl_double4 CombineTwoDouble2Vectors(const cl_double2& a, const cl_double2& b);
 
 template <typename T>